@@ -19,44 +19,90 @@
 // O processador entrará no manipulador de interrupção em resposta a isso,
 // onde o canal será reconfigurado e reiniciado.
 // Esse processo se repete.
+//
+// Enquanto o handler reprograma o canal, o PIO fica sem dados pelo tempo
+// da latência da interrupção. Com CHANNEL_IRQ_FLUXO_DMA = 1, o mesmo PWM
+// usa o fluxo ping-pong do pico-scheduler (fluxo_dma.h): dois canais
+// encadeados tocam metades alternadas de um buffer duplo e a IRQ apenas
+// preenche a metade que acabou de tocar, sem lacunas na saída.
+//
+// Os padrões de bits de cada nível vêm de padrao_pwm.h, gerados em main()
+// antes de habilitar a IRQ: o handler só troca o ponteiro. Com mais de 32
+// níveis (N_PWM_LEVELS = 64, 256...), cada padrão ocupa várias palavras e o
+// canal o repete com um anel de leitura. No modo fluxo, um modulador
+// sigma-delta cria 256 passos intermediários entre dois níveis.
 
 #include <stdio.h>
 #include "hardware/dma.h"
 #include "hardware/irq.h"
 #include "pio_serialiser.pio.h"
+#include "fluxo_dma.h"
+#include "padrao_pwm.h"
+
+#ifndef CHANNEL_IRQ_FLUXO_DMA
+#define CHANNEL_IRQ_FLUXO_DMA 0
+#endif
 
 // O PIO envia um bit a cada 10 ciclos do clock do sistema.
-// O DMA envia o mesmo valor de 32 bits 10.000 vezes antes de parar.
+// O DMA envia o mesmo padrão de 32 bits 10.000 vezes antes de parar.
 // Isso significa que percorremos os 32 níveis de PWM aproximadamente
 // uma vez por segundo.
 #define PIO_SERIAL_CLKDIV 10.f
 #define PWM_REPEAT_COUNT 10000
+#ifndef N_PWM_LEVELS
 #define N_PWM_LEVELS 32
+#endif
+
+// A entrada número `i` possui `i` bits 1 e `(N_PWM_LEVELS - i)` bits 0.
+static PADRAO_PWM_BUFFER(wavetable, N_PWM_LEVELS);
+static padrao_pwm_t tabela;
+
+// Cada metade do buffer duplo do fluxo tem 2^FLUXO_BITS bytes
+#define FLUXO_BITS 12
+#define FLUXO_PALAVRAS ((1u << FLUXO_BITS) / sizeof(uint32_t))
 
 int dma_chan;
 
 void dma_handler()
 {
     static int pwm_level = 0;
-    static uint32_t wavetable[N_PWM_LEVELS];
-    static bool first_run = true;
-    // A entrada número `i` possui `i` bits 1 e `(32 - i)` bits 0.
-    if (first_run)
-    {
-        first_run = false;
-        for (int i = 0; i < N_PWM_LEVELS; ++i)
-            wavetable[i] = ~(~0u << i);
-    }
 
     // Limpa a requisição de interrupção.
     dma_hw->ints0 = 1u << dma_chan;
-    // Fornece ao canal uma nova entrada da wavetable para leitura
-    // e o reaciona
-    dma_channel_set_read_addr(dma_chan, &wavetable[pwm_level], true);
+    // Fornece ao canal o padrão do próximo nível para leitura e o reaciona
+    dma_channel_set_read_addr(dma_chan, padrao_pwm_nivel(&tabela, pwm_level), true);
 
     pwm_level = (pwm_level + 1) % N_PWM_LEVELS;
 }
 
+#if CHANNEL_IRQ_FLUXO_DMA
+// Produtor do fluxo: copia um padrão por período, escolhido pelo
+// sigma-delta. O nível sobe um passo fracionário (1/256 de nível) a cada
+// PWM_REPEAT_COUNT / 256 palavras, no mesmo ritmo do dma_handler acima.
+static padrao_pwm_sigma_delta_t modulador;
+
+static void produzir_pwm(uint32_t *buffer, uint32_t palavras, void *contexto)
+{
+    static uint32_t repeticoes = 0;
+    const uint32_t passos = 1u << PADRAO_PWM_BITS_FRACAO;
+    (void)contexto;
+
+    for (uint32_t i = 0; i < palavras; i += tabela.palavras)
+    {
+        const uint32_t *padrao = padrao_pwm_sigma_delta_proximo(&modulador);
+        for (uint32_t j = 0; j < tabela.palavras; ++j)
+            buffer[i + j] = padrao[j];
+
+        repeticoes += tabela.palavras;
+        if (repeticoes >= PWM_REPEAT_COUNT / passos)
+        {
+            repeticoes = 0;
+            padrao_pwm_sigma_delta_alvo(&modulador, (modulador.alvo + 1) % (N_PWM_LEVELS * passos));
+        }
+    }
+}
+#endif
+
 int main()
 {
 #ifndef PICO_DEFAULT_LED_PIN
@@ -66,13 +112,25 @@ int main()
     uint offset = pio_add_program(pio0, &pio_serialiser_program);
     pio_serialiser_program_init(pio0, 0, offset, PICO_DEFAULT_LED_PIN, PIO_SERIAL_CLKDIV);
 
-    // Configura um canal para escrever repetidamente a mesma palavra (32 bits)
-    // no FIFO TX da SM0 do PIO0, sincronizado pelo sinal de requisição
-    // de dados desse periférico.
+    // Gera os padrões de todos os níveis antes de qualquer IRQ
+    padrao_pwm_init(&tabela, wavetable, N_PWM_LEVELS);
+
+#if CHANNEL_IRQ_FLUXO_DMA
+    padrao_pwm_sigma_delta_init(&modulador, &tabela, 0);
+    static uint32_t buffer_duplo[2][FLUXO_PALAVRAS] __attribute__((aligned(1u << FLUXO_BITS)));
+    static fluxo_dma_t fluxo;
+    fluxo_dma_init(&fluxo, &pio0_hw->txf[0], DREQ_PIO0_TX0, buffer_duplo[0], FLUXO_BITS,
+                   produzir_pwm, NULL);
+#else
+    // Configura um canal para escrever repetidamente o mesmo padrão no FIFO
+    // TX da SM0 do PIO0, sincronizado pelo sinal de requisição de dados desse
+    // periférico. O anel de leitura do tamanho de um padrão faz o canal
+    // voltar ao início dele (com 32 níveis, é sempre a mesma palavra).
     dma_chan = dma_claim_unused_channel(true);
     dma_channel_config c = dma_channel_get_default_config(dma_chan);
     channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
-    channel_config_set_read_increment(&c, false);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_ring(&c, false, padrao_pwm_bits_anel(&tabela));
     channel_config_set_dreq(&c, DREQ_PIO0_TX0);
 
     dma_channel_configure(
@@ -95,6 +153,8 @@ int main()
     // Chama manualmente o handler uma vez para iniciar a primeira transferência
     dma_handler();
 
+#endif
+
     // A partir daqui, tudo é controlado por interrupções.
     // O processador tem tempo para sentar e pensar na aposentadoria antecipada —
     // talvez abrir uma padaria?
@@ -13,6 +13,7 @@
 #include "pico/stdlib.h"
 #include "hardware/dma.h"
 #include "hardware/structs/uart.h"
+#include "cadeia_dma.h"
 
 // Esses buffers serão enviados via DMA para a UART, um após o outro.
 
@@ -120,5 +121,28 @@ int main()
     dma_hw->ints0 = 1u << data_chan;
 
     puts("DMA finalizado.");
+
+    // A mesma sequência montada em tempo de execução com cadeia_dma (do
+    // pico-scheduler): os iovecs apontam para as palavras sem copiá-las, a
+    // lista de blocos de controle é gerada pela biblioteca e o fim da cadeia
+    // é tratado na IRQ.
+    static cadeia_dma_t cadeia;
+    cadeia_dma_init(&cadeia, &uart_get_hw(uart_default)->dr,
+                    uart_get_dreq(uart_default, true), DMA_SIZE_8);
+
+    const cadeia_dma_iovec_t palavras[] = {
+        {word0, count_of(word0) - 1},
+        {word1, count_of(word1) - 1},
+        {word2, count_of(word2) - 1},
+        {word3, count_of(word3) - 1},
+        {word4, count_of(word4) - 1},
+        {word5, count_of(word5) - 1},
+    };
+    cadeia_dma_writev(&cadeia, palavras, count_of(palavras), NULL, NULL);
+
+    while (cadeia_dma_ocupada(&cadeia))
+        tight_loop_contents();
+
+    puts("cadeia_dma finalizada.");
 #endif
 }
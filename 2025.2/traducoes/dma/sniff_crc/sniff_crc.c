@@ -11,14 +11,15 @@
 // os dados de entrada usando o DMA.
 // Se for necessária uma cópia de dados *com* um sniff de CRC32, o endereço
 // inicial de um buffer de destino com tamanho adequado deve ser fornecido
-// e o 'write_increment' deve ser configurado como true (veja abaixo).
+// e o 'write_increment' deve ser configurado como true (veja abaixo), como
+// faz dma_memcpy_crc no pico-scheduler (hal/dma_memcpy_crc.h).
 
 #include <stdio.h>
 #include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/dma.h"
-
-#define CRC32_INIT ((uint32_t)-1l)
+#include "crc32.h"
+#include "crc_dma.h"
 
 #define DATA_TO_CHECK_LEN 9
 #define CRC32_LEN 4
@@ -28,24 +29,23 @@
 static uint8_t src[TOTAL_LEN] = {0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x00, 0x00, 0x00, 0x00};
 static uint8_t dummy_dst[1];
 
-// Isso usa um polinômio padrão com a direção de deslocamento alternativa
-// “reversa”.
+// Resultado da verificação em segundo plano (crc_dma), entregue pela IRQ
+static volatile bool verificacao_pronta = false;
+static volatile uint32_t crc_em_segundo_plano;
+
+static void ao_terminar_crc(uint32_t resultado, void *contexto)
+{
+    (void)contexto;
+    crc_em_segundo_plano = resultado;
+    verificacao_pronta = true;
+}
+
+// O CRC de referência é calculado por software com crc32_update (módulo
+// crc32 do pico-scheduler, por tabela/slice-by-8), que usa o polinômio
+// padrão com a direção de deslocamento alternativa “reversa”.
 // É possível usar um algoritmo não reverso aqui, mas a configuração do
 // sniff do DMA abaixo precisaria ser modificada para permanecer consistente
 // e permitir que a verificação passe.
-static uint32_t soft_crc32_block(uint32_t crc, uint8_t *bytp, uint32_t length)
-{
-    while (length--)
-    {
-        uint32_t byte32 = (uint32_t)*bytp++;
-
-        for (uint8_t bit = 8; bit; bit--, byte32 >>= 1)
-        {
-            crc = (crc >> 1) ^ (((crc ^ byte32) & 1ul) ? 0xEDB88320ul : 0ul);
-        }
-    }
-    return crc;
-}
 
 int main()
 {
@@ -54,7 +54,7 @@ int main()
     stdio_init_all();
 
     // Calcula e anexa o CRC
-    crc_res = soft_crc32_block(CRC32_INIT, src, DATA_TO_CHECK_LEN);
+    crc_res = crc32_update(CRC32_INIT, src, DATA_TO_CHECK_LEN);
     *((uint32_t *)&src[DATA_TO_CHECK_LEN]) = crc_res;
 
     printf("Buffer para DMA: ");
@@ -113,4 +113,28 @@ int main()
     {
         printf("ERRO - Verificação CRC32 FALHOU!\n");
     }
+
+    // A mesma verificação com o serviço crc_dma do pico-scheduler: o buffer
+    // é entregue em pedaços (aqui, uma lista com dados e CRC separados) e o
+    // acumulador do sniffer segue de um pedaço para o outro. O resultado
+    // chega por IRQ, sem dma_channel_wait_for_finish_blocking.
+    static const crc_dma_bloco_t pedacos[] = {
+        {DATA_TO_CHECK_LEN, src},
+        {CRC32_LEN, src + DATA_TO_CHECK_LEN},
+        {0, NULL},
+    };
+
+    crc_dma_init();
+    crc_dma_iniciar(CRC_DMA_CRC32, CRC32_INIT);
+    crc_dma_adicionar_lista(pedacos);
+    crc_dma_finalizar(ao_terminar_crc, NULL);
+
+    // O processador fica livre enquanto o DMA percorre os pedaços
+    while (!verificacao_pronta)
+    {
+        tight_loop_contents();
+    }
+
+    printf("crc_dma em 2 pedaços, resultado: 0x%x (%s)\n", crc_em_segundo_plano,
+           crc_em_segundo_plano == 0 ? "correto" : "FALHOU");
 }
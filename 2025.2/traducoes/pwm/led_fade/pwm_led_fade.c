@@ -6,12 +6,24 @@
 
 // Fade an LED between low and high brightness. An interrupt handler updates
 // the PWM slice's output level each time the counter wraps.
+//
+// Com PWM_LED_FADE_DMA = 1, o mesmo fade é feito sem interrupções pelo
+// fade_pwm do pico-scheduler: a curva (com correção de gama) é calculada
+// uma vez e um canal de DMA escreve o próximo nível a cada wrap do contador.
 
 #include "pico/stdlib.h"
 #include <stdio.h>
 #include "pico/time.h"
 #include "hardware/irq.h"
 #include "hardware/pwm.h"
+#include "fade_pwm.h"
+
+#ifndef PWM_LED_FADE_DMA
+#define PWM_LED_FADE_DMA 0
+#endif
+
+// 256 passos de subida e 256 de descida, um por wrap, como no tratador
+#define FADE_PASSOS 512
 
 #ifdef PICO_DEFAULT_LED_PIN
 void on_pwm_wrap() {
@@ -48,12 +60,14 @@ int main() {
     // Descobre qual slice acabamos de conectar ao pino do LED
     uint slice_num = pwm_gpio_to_slice_num(PICO_DEFAULT_LED_PIN);
 
+#if !PWM_LED_FADE_DMA
     // Faz o mascaramento da saída de IRQ do nosso slice na única linha de interrupção do bloco PWM
     // e registra nosso tratador de interrupção
     pwm_clear_irq(slice_num);
     pwm_set_irq_enabled(slice_num, true);
     irq_set_exclusive_handler(PWM_DEFAULT_IRQ_NUM(), on_pwm_wrap);
     irq_set_enabled(PWM_DEFAULT_IRQ_NUM(), true);
+#endif
 
     // Obtém alguns valores padrão razoáveis para a configuração do slice. Por padrão, o
     // contador pode fazer wrap em todo o seu intervalo máximo (0 a 2**16-1)
@@ -63,8 +77,17 @@ int main() {
     // Carrega a configuração no nosso slice de PWM e inicia sua execução.
     pwm_init(slice_num, &config, true);
 
-    // A partir deste ponto, tudo acontece no tratador de interrupção do PWM, então
-    // podemos apenas aguardar
+#if PWM_LED_FADE_DMA
+    // Tabela em anel com a ida e a volta; o DMA a repete indefinidamente
+    static FADE_PWM_TABELA(tabela, FADE_PASSOS);
+    static fade_pwm_t fade;
+    fade_pwm_init(&fade, slice_num, tabela, FADE_PASSOS);
+    fade_pwm_curva(&fade, pwm_gpio_to_channel(PICO_DEFAULT_LED_PIN), fade_pwm_linear, 0.f, 1.f, true);
+    fade_pwm_iniciar(&fade, true);
+#endif
+
+    // A partir deste ponto, tudo acontece no tratador de interrupção do PWM
+    // (ou no DMA), então podemos apenas aguardar
     while (1)
         tight_loop_contents();
 #endif
@@ -9,6 +9,23 @@
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
+#include "captura_pwm.h"
+#include "medida_fixa.h"
+
+// Com MEASURE_DUTY_CYCLE_CAPTURA = 1, a medição usa o serviço captura_pwm do
+// pico-scheduler: um temporizador fecha janelas de 10 ms em segundo plano,
+// alternando entre ciclo de trabalho e frequência, e o laço apenas lê o
+// último resultado, sem bloquear. Outros pinos de canal B podem ser medidos
+// ao mesmo tempo com captura_pwm_adicionar.
+#ifndef MEASURE_DUTY_CYCLE_CAPTURA
+#define MEASURE_DUTY_CYCLE_CAPTURA 0
+#endif
+
+#define JANELA_CAPTURA_US 10000
+
+// Medição bloqueante: divisor do contador e duração da janela
+#define DIVISOR_MEDIDA 100
+#define JANELA_MEDIDA_US 10000
 
 // Este exemplo gera uma saída PWM com diferentes duty cycles e usa
 // outro slice de PWM em modo de entrada para medir o duty cycle. Você precisará
@@ -16,7 +33,12 @@
 const uint OUTPUT_PIN = 2;
 const uint MEASURE_PIN = 5;
 
-float measure_duty_cycle(uint gpio) {
+// Converte a contagem em ciclo de trabalho (ppm) sem float: o M0+ não tem
+// FPU, então a razão para o relógio atual é calculada uma vez, no início,
+// e cada medida custa só uma multiplicação inteira.
+static medida_fixa_escala_t escala_ciclo;
+
+uint32_t measure_duty_cycle_ppm(uint gpio) {
     // Apenas os pinos PWM do canal B podem ser usados como entradas.
     assert(pwm_gpio_to_channel(gpio) == PWM_CHAN_B);
     uint slice_num = pwm_gpio_to_slice_num(gpio);
@@ -24,26 +46,31 @@ float measure_duty_cycle(uint gpio) {
     // Conta uma vez a cada 100 ciclos em que a entrada PWM B estiver em nível alto
     pwm_config cfg = pwm_get_default_config();
     pwm_config_set_clkdiv_mode(&cfg, PWM_DIV_B_HIGH);
-    pwm_config_set_clkdiv(&cfg, 100);
+    pwm_config_set_clkdiv_int(&cfg, DIVISOR_MEDIDA);
     pwm_init(slice_num, &cfg, false);
     gpio_set_function(gpio, GPIO_FUNC_PWM);
 
     pwm_set_enabled(slice_num, true);
-    sleep_ms(10);
+    sleep_us(JANELA_MEDIDA_US);
     pwm_set_enabled(slice_num, false);
-    float counting_rate = clock_get_hz(clk_sys) / 100;
-    float max_possible_count = counting_rate * 0.01;
-    return pwm_get_counter(slice_num) / max_possible_count;
+    return medida_fixa_aplicar(&escala_ciclo, pwm_get_counter(slice_num));
 }
 
-const float test_duty_cycles[] = {
-        0.f,
-        0.1f,
-        0.5f,
-        0.9f,
-        1.f
+// Ciclos de trabalho de teste, em partes por milhão
+const uint32_t test_duty_cycles_ppm[] = {
+        0,
+        100000,
+        500000,
+        900000,
+        1000000
 };
 
+// Escreve um valor em ppm como porcentagem com uma casa decimal
+static void print_percent(uint32_t ppm) {
+    uint32_t decimos = (ppm + 500) / 1000;
+    printf("%lu.%lu%%", (unsigned long) (decimos / 10), (unsigned long) (decimos % 10));
+}
+
 int main() {
     stdio_init_all();
     printf("\nPWM duty cycle measurement example\n");
@@ -59,14 +86,35 @@ int main() {
     // “free-running”. Não é recomendável conectar duas saídas diretamente!
     gpio_set_function(OUTPUT_PIN, GPIO_FUNC_PWM);
 
+    medida_fixa_ciclo_init(&escala_ciclo, clock_get_hz(clk_sys), DIVISOR_MEDIDA, JANELA_MEDIDA_US);
+
+#if MEASURE_DUTY_CYCLE_CAPTURA
+    captura_pwm_init(JANELA_CAPTURA_US);
+    captura_pwm_adicionar(MEASURE_PIN);
+#endif
+
     // Para cada duty cycle de teste, gera a saída nesse nível
     // e lê o duty cycle real usando o outro pino. Os dois valores
     // devem ser bem próximos!
-    for (uint i = 0; i < count_of(test_duty_cycles); ++i) {
-        float output_duty_cycle = test_duty_cycles[i];
-        pwm_set_gpio_level(OUTPUT_PIN, (uint16_t) (output_duty_cycle * (count_top + 1)));
-        float measured_duty_cycle = measure_duty_cycle(MEASURE_PIN);
-        printf("Output duty cycle = %.1f%%, measured input duty cycle = %.1f%%\n",
-               output_duty_cycle * 100.f, measured_duty_cycle * 100.f);
+    for (uint i = 0; i < count_of(test_duty_cycles_ppm); ++i) {
+        uint32_t output_duty_cycle = test_duty_cycles_ppm[i];
+        pwm_set_gpio_level(OUTPUT_PIN, (uint16_t) (output_duty_cycle * (count_top + 1) / 1000000));
+#if MEASURE_DUTY_CYCLE_CAPTURA
+        // Espera as duas grandezas serem medidas já com o novo nível
+        sleep_us(3 * JANELA_CAPTURA_US);
+        captura_pwm_leitura_t leitura;
+        captura_pwm_ler(MEASURE_PIN, &leitura);
+        uint32_t measured_duty_cycle = leitura.ciclo_ppm;
+#else
+        uint32_t measured_duty_cycle = measure_duty_cycle_ppm(MEASURE_PIN);
+#endif
+        printf("Output duty cycle = ");
+        print_percent(output_duty_cycle);
+        printf(", measured input duty cycle = ");
+        print_percent(measured_duty_cycle);
+#if MEASURE_DUTY_CYCLE_CAPTURA
+        printf(", frequency = %lu Hz", (unsigned long) (leitura.frequencia_mhz / 1000u));
+#endif
+        printf("\n");
     }
 }
\ No newline at end of file
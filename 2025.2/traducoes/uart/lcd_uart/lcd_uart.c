@@ -18,13 +18,26 @@
    GPIO 8 (pino 11) -> RX no backpack
    3.3V (pino 36)   -> 3.3V no backpack
    GND (pino 38)    -> GND no backpack
+
+   Os comandos não são enviados um a um: lcd_write os acumula num buffer e
+   lcd_flush entrega o buffer inteiro ao DMA (uart_tx_dma, do diretório
+   pico-scheduler/hal), que alimenta a UART no ritmo do seu FIFO. Assim a
+   CPU não fica presa esperando cada byte a 9600 baud.
+
+   Comandos lentos (limpar a tela e os de configuração, que o backpack grava
+   na EEPROM) precisam de um intervalo antes do próximo byte. Em vez de um
+   sleep_ms, o buffer termina no comando lento e um alarme segura o envio do
+   buffer seguinte até o intervalo passar.
 */
 
 #include <stdio.h>
 #include <math.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/uart.h"
+#include "hardware/sync.h"
+#include "uart_tx_dma.h"
 
 // deixa a uart0 livre para stdio
 #define UART_ID uart1
@@ -60,14 +73,168 @@
 // altere para 0 se o display não suportar RGB
 #define LCD_IS_RGB 1
 
+// tamanho de cada buffer de comandos; uma tela cheia com comandos cabe num só
+#define LCD_BUFFER_TAMANHO 128
+
+// tempo para o display processar um comando lento
+#define LCD_PAUSA_MS 10
+
+// bit do contexto do envio que pede a pausa depois do buffer
+#define LCD_CONTEXTO_PAUSA 2u
+
+static uart_tx_dma_t lcd_tx;
+
+// dois buffers: um é preenchido enquanto o outro é enviado pelo DMA
+static uint8_t lcd_buffers[2][LCD_BUFFER_TAMANHO];
+static volatile bool lcd_buffer_ocupado[2];
+static uint lcd_buffer_atual = 0;
+static uint lcd_buffer_usado = 0;
+
+// o buffer atual termina num comando lento
+static bool lcd_comando_lento = false;
+
+// pausa depois de um comando lento: da entrega dele ao DMA até o alarme
+static volatile bool lcd_em_pausa = false;
+
+// buffer entregue durante a pausa, enviado pelo alarme (tamanho 0 = nenhum)
+static uint lcd_retido = 0;
+static volatile uint lcd_retido_usado = 0;
+static bool lcd_retido_lento = false;
+
+static void lcd_buffer_enviado(void *contexto);
+
+static void lcd_enviar(uint buffer, uint usado, bool lento)
+{
+    // a pausa começa já na entrega: o próximo buffer não pode entrar no
+    // mesmo lote de DMA que o comando lento
+    if (lento)
+        lcd_em_pausa = true;
+
+    uintptr_t contexto = buffer | (lento ? LCD_CONTEXTO_PAUSA : 0);
+    while (!uart_tx_dma_enviar(&lcd_tx, lcd_buffers[buffer], usado,
+                               lcd_buffer_enviado, (void *)contexto))
+        tight_loop_contents();
+}
+
+static int64_t lcd_fim_pausa(__unused alarm_id_t id, __unused void *contexto)
+{
+    // chamado no alarme: libera a UART e envia o buffer que esperava
+    lcd_em_pausa = false;
+    if (lcd_retido_usado > 0)
+    {
+        uint usado = lcd_retido_usado;
+        lcd_retido_usado = 0;
+        lcd_enviar(lcd_retido, usado, lcd_retido_lento);
+    }
+    return 0;
+}
+
+static void lcd_buffer_enviado(void *contexto)
+{
+    // chamado na IRQ de DMA quando o buffer já foi todo para a UART; depois
+    // de um comando lento, o intervalo conta a partir daqui
+    uintptr_t valor = (uintptr_t)contexto;
+    lcd_buffer_ocupado[valor & 1u] = false;
+
+    if ((valor & LCD_CONTEXTO_PAUSA) &&
+        add_alarm_in_ms(LCD_PAUSA_MS, lcd_fim_pausa, NULL, true) <= 0)
+        lcd_fim_pausa(0, NULL); // sem alarme livre: segue sem a pausa
+}
+
+void lcd_flush()
+{
+    // entrega os comandos acumulados ao DMA e passa a preencher o outro buffer
+    if (lcd_buffer_usado == 0)
+        return;
+
+    // os dois buffers ocupados (um deles retido): espera o alarme envia-lo
+    while (lcd_retido_usado > 0)
+        tight_loop_contents();
+
+    lcd_buffer_ocupado[lcd_buffer_atual] = true;
+
+    // durante a pausa de um comando lento, o buffer fica retido e o alarme
+    // o envia quando a pausa terminar
+    uint32_t salvo = save_and_disable_interrupts();
+    bool reter = lcd_em_pausa;
+    if (reter)
+    {
+        lcd_retido = lcd_buffer_atual;
+        lcd_retido_usado = lcd_buffer_usado;
+        lcd_retido_lento = lcd_comando_lento;
+    }
+    restore_interrupts(salvo);
+
+    if (!reter)
+        lcd_enviar(lcd_buffer_atual, lcd_buffer_usado, lcd_comando_lento);
+
+    lcd_buffer_atual ^= 1;
+    lcd_buffer_usado = 0;
+    lcd_comando_lento = false;
+
+    // só espera se o outro buffer ainda estiver sendo enviado
+    while (lcd_buffer_ocupado[lcd_buffer_atual])
+        tight_loop_contents();
+}
+
+static void lcd_append(const uint8_t *buf, uint8_t buflen)
+{
+    // o que cabe num buffer vazio não é dividido entre dois envios
+    if (lcd_buffer_usado + buflen > LCD_BUFFER_TAMANHO && buflen <= LCD_BUFFER_TAMANHO)
+        lcd_flush();
+
+    // maior que um buffer (até 255 bytes): vai em pedaços, com um envio
+    // sempre que o buffer enche
+    while (buflen > 0)
+    {
+        if (lcd_buffer_usado == LCD_BUFFER_TAMANHO)
+            lcd_flush();
+
+        uint pedaco = MIN(buflen, LCD_BUFFER_TAMANHO - lcd_buffer_usado);
+        memcpy(&lcd_buffers[lcd_buffer_atual][lcd_buffer_usado], buf, pedaco);
+        lcd_buffer_usado += pedaco;
+        buf += pedaco;
+        buflen -= pedaco;
+    }
+}
+
+static bool lcd_lento(uint8_t cmd)
+{
+    // limpar a tela e os comandos gravados na EEPROM do backpack
+    switch (cmd)
+    {
+    case LCD_CLEAR_SCREEN:
+    case LCD_SET_DISPLAY_SIZE:
+    case LCD_SET_CONTRAST:
+    case LCD_SET_BRIGHTNESS:
+    case LCD_SET_SPLASH:
+    case LCD_SET_BACKLIGHT_COLOR:
+        return true;
+    default:
+        return false;
+    }
+}
+
 void lcd_write(uint8_t cmd, uint8_t *buf, uint8_t buflen)
 {
-    // todos os comandos são prefixados com 0xFE
-    const uint8_t pre = 0xFE;
-    uart_write_blocking(UART_ID, &pre, 1);
-    uart_write_blocking(UART_ID, &cmd, 1);
-    uart_write_blocking(UART_ID, buf, buflen);
-    sleep_ms(10); // dá um pequeno tempo para o display processar
+    // todos os comandos são prefixados com 0xFE; o comando só é enviado
+    // no próximo lcd_flush, junto com os demais
+    const uint8_t cabecalho[] = {0xFE, cmd};
+    lcd_append(cabecalho, 2);
+    lcd_append(buf, buflen);
+
+    // um comando lento encerra o buffer: o que vier depois espera a pausa
+    if (lcd_lento(cmd))
+    {
+        lcd_comando_lento = true;
+        lcd_flush();
+    }
+}
+
+void lcd_putc(char c)
+{
+    // bytes não precedidos por 0xFE são exibidos como texto
+    lcd_append((const uint8_t *)&c, 1);
 }
 
 void lcd_set_size(uint8_t w, uint8_t h)
@@ -109,7 +276,8 @@ void lcd_set_backlight(bool is_on)
     // liga (true) ou desliga (false) o backlight
     if (is_on)
     {
-        lcd_write(LCD_DISPLAY_ON, (uint8_t *)0, 1);
+        uint8_t minutos = 0; // 0 = nunca desliga sozinho
+        lcd_write(LCD_DISPLAY_ON, &minutos, 1);
     }
     else
     {
@@ -145,6 +313,7 @@ void lcd_init()
     lcd_set_contrast(155);
     lcd_set_brightness(255);
     lcd_set_cursor(false);
+    lcd_flush();
 }
 
 int main()
@@ -153,6 +322,7 @@ int main()
     uart_init(UART_ID, BAUD_RATE);
     uart_set_translate_crlf(UART_ID, false);
     gpio_set_function(UART_TX_PIN, UART_FUNCSEL_NUM(UART_ID, UART_TX_PIN));
+    uart_tx_dma_init(&lcd_tx, UART_ID);
 
     bi_decl(bi_1pin_with_func(UART_TX_PIN, UART_FUNCSEL_NUM(UART_ID, UART_TX_PIN)));
 
@@ -165,6 +335,7 @@ int main()
 
     lcd_cursor_reset();
     lcd_clear();
+    lcd_flush();
 
 #if LCD_IS_RGB
     uint8_t i = 0; // não tem problema se isso estourar e voltar, estamos usando seno
@@ -180,7 +351,7 @@ int main()
         // são interpretados como texto a ser exibido no backpack,
         // então apenas enviamos o caractere pela UART!
         if (c < 128)
-            uart_putc_raw(UART_ID, c); // ignora caracteres extras não-ASCII
+            lcd_putc(c); // ignora caracteres extras não-ASCII
 #if LCD_IS_RGB
         // muda a cor do display a cada tecla pressionada, estilo arco-íris!
         red = (uint8_t)(sin(frequency * i + 0) * 127 + 128);
@@ -189,5 +360,7 @@ int main()
         lcd_set_backlight_color(red, green, blue);
         i++;
 #endif
+        // o caractere e a nova cor seguem juntos num único envio por DMA
+        lcd_flush();
     }
 }
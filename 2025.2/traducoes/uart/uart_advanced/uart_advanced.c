@@ -7,6 +7,7 @@
 #include "pico/stdlib.h"
 #include "hardware/uart.h"
 #include "hardware/irq.h"
+#include "uart_rx_dma.h"
 
 /// \tag::uart_advanced[]
 
@@ -21,22 +22,51 @@
 #define UART_TX_PIN 0
 #define UART_RX_PIN 1
 
+// Linha parada por 32 bits de tempo encerra um quadro
+#define RX_TIMEOUT_US (32u * 1000000u / BAUD_RATE)
+
+// Anel de recepção: 2^RX_ANEL_BITS bytes, alinhado ao próprio tamanho
+// para o modo de anel do DMA
+#define RX_ANEL_BITS 12
+
+static uint8_t rx_anel[1u << RX_ANEL_BITS] __attribute__((aligned(1u << RX_ANEL_BITS)));
+static uart_rx_dma_t rx;
+
 static int chars_rxed = 0;
+static int trechos_sobrescritos = 0;
+static volatile int quadros_rxed = 0;
 
-// Manipulador de interrupção de RX
-void on_uart_rx()
+// Chamado quando a linha fica parada depois de receber dados (quadro parcial)
+void on_uart_rx_timeout(__unused void *contexto)
 {
-    while (uart_is_readable(UART_ID))
+    quadros_rxed++;
+}
+
+// Processa os bytes recebidos direto do anel, sem copiá-los
+void process_rx()
+{
+    const uint8_t *dados;
+    uint32_t n;
+
+    while ((n = uart_rx_dma_peek(&rx, &dados)) > 0)
     {
-        uint8_t ch = uart_getc(UART_ID);
-        // Podemos enviá-lo de volta?
-        if (uart_is_writable(UART_ID))
+        for (uint32_t i = 0; i < n; i++)
         {
-            // Altere-o um pouco primeiro!
-            ch++;
-            uart_putc(UART_ID, ch);
+            // Podemos enviá-lo de volta?
+            if (uart_is_writable(UART_ID))
+            {
+                // Altere-o um pouco primeiro!
+                uart_putc(UART_ID, dados[i] + 1);
+            }
+        }
+        chars_rxed += n;
+
+        // O DMA deu a volta no anel enquanto o trecho era processado: parte
+        // do que foi refletido já era de dados mais novos
+        if (!uart_rx_dma_consume(&rx, n))
+        {
+            trechos_sobrescritos++;
         }
-        chars_rxed++;
     }
 }
 
@@ -61,28 +91,19 @@ int main()
     // Configura o formato dos dados
     uart_set_format(UART_ID, DATA_BITS, STOP_BITS, PARITY);
 
-    // Desativa os FIFOs - queremos fazer isso caractere por caractere
-    uart_set_fifo_enabled(UART_ID, false);
-
-    // Configura uma interrupção de RX
-    // Precisamos configurar o manipulador primeiro
-    // Seleciona a interrupção correta para a UART que estamos usando
-    int UART_IRQ = UART_ID == uart0 ? UART0_IRQ : UART1_IRQ;
-
-    // E configura e habilita os manipuladores de interrupção
-    irq_set_exclusive_handler(UART_IRQ, on_uart_rx);
-    irq_set_enabled(UART_IRQ, true);
-
-    // Agora habilita a UART para enviar interrupções - apenas RX
-    uart_set_irq_enables(UART_ID, true, false);
+    // Os FIFOs ficam habilitados e um canal de DMA copia cada byte recebido
+    // para o anel, então não há uma interrupção por caractere: a CPU só é
+    // avisada quando a linha fica parada (timeout de recepção).
+    uart_rx_dma_init(&rx, UART_ID, rx_anel, RX_ANEL_BITS, RX_TIMEOUT_US,
+                     on_uart_rx_timeout, NULL);
 
     // OK, tudo configurado.
-    // Vamos enviar uma string básica e então rodar um loop esperando por interrupções de RX
-    // O manipulador irá contá-las, mas também refletirá os dados recebidos de volta com uma leve alteração!
-    uart_puts(UART_ID, "\nHello, uart interrupts\n");
+    // Vamos enviar uma string básica e então rodar um loop consumindo o anel
+    // Os dados recebidos são contados e refletidos de volta com uma leve alteração!
+    uart_puts(UART_ID, "\nHello, uart DMA\n");
 
     while (1)
-        tight_loop_contents();
+        process_rx();
 }
 
 /// \end:uart_advanced[]
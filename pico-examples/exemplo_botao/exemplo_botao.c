@@ -1,10 +1,41 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "eventos_gpio.h"
 
 #define vermelho 11
 
 #define btn 10
 
+// Tempo que o botão precisa ficar estável para valer como pressionado/solto
+#define DEBOUNCE_US 20000
+
+// O botão é lido por eventos (eventos_gpio, do pico-scheduler): cada borda
+// gera uma interrupção com debounce, e o laço principal dorme em __wfi()
+// até haver algo a tratar. O LED reage ao botão em milissegundos, em vez de
+// até 500 ms, e a CPU não fica consultando o pino.
+
+static repeating_timer_t pisca;
+static bool piscando = false;
+
+// Inverte o LED a cada 500 ms enquanto o botão estiver pressionado
+bool alternar_led(repeating_timer_t *t) {
+  (void)t;
+  gpio_xor_mask(1u << vermelho);
+  return true;
+}
+
+void tratar_evento(const evento_gpio_t *evento) {
+  if (evento->nivel && !piscando) {
+    gpio_put(vermelho, 1);
+    add_repeating_timer_ms(500, alternar_led, NULL, &pisca);
+    piscando = true;
+  } else if (!evento->nivel && piscando) {
+    cancel_repeating_timer(&pisca);
+    gpio_put(vermelho, 0);
+    piscando = false;
+  }
+}
 
 int main() {
   stdio_init_all();
@@ -12,17 +43,26 @@ int main() {
   gpio_init(vermelho);
   gpio_set_dir(vermelho, GPIO_OUT);
 
-  gpio_init(btn);
-  gpio_set_dir(btn, GPIO_IN);
+  // O pull-down vem antes: o nível inicial é lido ao adicionar o pino
   gpio_pull_down(btn);
+  eventos_gpio_init();
+  eventos_gpio_adicionar(btn, DEBOUNCE_US);
 
 
   while (true) {
-    if(gpio_get(btn)){
-        gpio_put(vermelho, 1);
-        sleep_ms(500);
-        gpio_put(vermelho, 0);
-        sleep_ms(500);
+    evento_gpio_t evento;
+
+    // Com as interrupções desabilitadas, um evento que chegue entre a
+    // consulta e o __wfi() ainda acorda o processador
+    uint32_t salvo = save_and_disable_interrupts();
+    bool ha_evento = eventos_gpio_proximo(&evento);
+    if (!ha_evento) {
+      __wfi();
+    }
+    restore_interrupts(salvo);
+
+    if (ha_evento) {
+      tratar_evento(&evento);
     }
   }
-}
\ No newline at end of file
+}
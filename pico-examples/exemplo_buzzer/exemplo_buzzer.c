@@ -1,50 +1,70 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
-#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "eventos_gpio.h"
+#include "melodia.h"
 
 #define buzzer 9
 
 #define btn 10
 
-#define NOTE_C5 523     // Frequência da nota C5 em Hz
+#define NOTE_C5 523     // Frequências das notas em Hz
+#define NOTE_E5 659
+#define NOTE_G5 784
+#define NOTE_C6 1047
 
+// Tempo que o botão precisa ficar estável para valer como pressionado/solto
+#define DEBOUNCE_US 20000
 
-void play_note(uint buzzer_pin, uint frequency) {
-    gpio_set_function(buzzer_pin, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(buzzer_pin);
-    uint clkdiv = 4; // Define um divisor de clock
-    uint wrap = 125000000 / (clkdiv * frequency);
-    pwm_set_wrap(slice_num, wrap);
-    pwm_set_clkdiv(slice_num, clkdiv);
-    pwm_set_chan_level(slice_num, pwm_gpio_to_channel(buzzer_pin), wrap / 2);
-    pwm_set_enabled(slice_num, true);
-}
+// O botão é lido por eventos (eventos_gpio, do pico-scheduler) e a melodia
+// toca em segundo plano (melodia, também do pico-scheduler): as notas são
+// convertidas uma vez para os registradores de PWM, com o relógio real do
+// sistema, e um alarme troca de nota sem bloquear o laço principal. Outros
+// buzzers, em fatias de PWM diferentes, podem tocar ao mesmo tempo, cada um
+// com seu melodia_t.
 
-void stop_buzzer(uint buzzer_pin) {
-    uint slice_num = pwm_gpio_to_slice_num(buzzer_pin);
-    pwm_set_enabled(slice_num, false);
-}
+static const nota_t arpejo[] = {
+    {NOTE_C5, 150},
+    {NOTE_E5, 150},
+    {NOTE_G5, 150},
+    {NOTE_C6, 300},
+    {0, 250},       // pausa
+};
+
+static nota_pwm_t arpejo_pwm[count_of(arpejo)];
+static melodia_t som;
 
 int main() {
   stdio_init_all();
 
-  gpio_init(buzzer);
-  gpio_set_dir(buzzer, GPIO_OUT);
-  gpio_put(buzzer, 0);
+  melodia_init(&som, buzzer);
+  melodia_preparar(arpejo, count_of(arpejo), arpejo_pwm);
 
-  gpio_init(btn);
-  gpio_set_dir(btn, GPIO_IN);
+  // O pull-down vem antes: o nível inicial é lido ao adicionar o pino
   gpio_pull_down(btn);
+  eventos_gpio_init();
+  eventos_gpio_adicionar(btn, DEBOUNCE_US);
 
 
   while (true) {
-    if(gpio_get(btn)){
-        play_note(buzzer, NOTE_C5);
-        sleep_ms(500);
-        stop_buzzer(buzzer);
-    }else{
-        stop_buzzer(buzzer);
-        sleep_ms(500);
+    evento_gpio_t evento;
+
+    // Com as interrupções desabilitadas, um evento que chegue entre a
+    // consulta e o __wfi() ainda acorda o processador
+    uint32_t salvo = save_and_disable_interrupts();
+    bool ha_evento = eventos_gpio_proximo(&evento);
+    if (!ha_evento) {
+      __wfi();
+    }
+    restore_interrupts(salvo);
+
+    // Toca o arpejo em laço enquanto o botão estiver pressionado
+    if (ha_evento) {
+      if (evento.nivel) {
+        melodia_tocar(&som, arpejo_pwm, count_of(arpejo_pwm), true);
+      } else {
+        melodia_parar(&som);
+      }
     }
   }
-}
\ No newline at end of file
+}
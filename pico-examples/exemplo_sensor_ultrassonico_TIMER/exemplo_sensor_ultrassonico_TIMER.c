@@ -1,62 +1,60 @@
 #include <stdio.h>
 #include "pico/stdlib.h"
-#include "hardware/gpio.h"
-#include "hardware/timer.h"
+#include "ultrassom.h"
 
 // Define os pinos usados pelo sensor ultrassônico
 #define PINO_TRIG 28
 #define PINO_ECHO 27
 
-// Envia um pulso de disparo de 10 microssegundos para iniciar a medição
-void enviar_pulso_ultrassonico()
-{
-    gpio_put(PINO_TRIG, 1);
-    sleep_us(10);
-    gpio_put(PINO_TRIG, 0);
-}
-
-// Mede a duração do pulso recebido no pino ECHO, que representa o tempo de ida e volta do som
-uint32_t medir_tempo_echo()
-{
-    while (gpio_get(PINO_ECHO) == 0)
-        ;
-    absolute_time_t inicio = get_absolute_time();
-
-    while (gpio_get(PINO_ECHO) == 1)
-        ;
-    absolute_time_t fim = get_absolute_time();
+// Um disparo a cada 60 ms (intervalo recomendado para o HC-SR04) e no máximo
+// 25 ms de espera pelo eco (~4,3 m, além do alcance do sensor)
+#define PERIODO_US 60000
+#define LIMITE_ECO_US 25000
 
-    return absolute_time_diff_us(inicio, fim);
-}
+// O pulso de disparo e a medida do eco são feitos por uma máquina de estado
+// do PIO (ultrassom, do pico-scheduler), com limite de espera: a CPU não fica
+// presa esperando o pino ECHO e o programa não trava se o eco não voltar.
+// As amostras chegam a cada PERIODO_US, já filtradas (mediana e média
+// móvel); aqui o laço só lê a última.
 
-// Calcula a distância em centímetros com base na duração do pulso
-float medir_distancia_cm()
+// Escreve uma distância em micrômetros como centímetros com duas casas
+static void imprimir_distancia(const char *rotulo, uint32_t distancia_um)
 {
-    enviar_pulso_ultrassonico();
-    uint32_t duracao_us = medir_tempo_echo();
-    float distancia = (duracao_us * 0.0343f) / 2.0f;
-    return distancia;
+    uint32_t centesimos = (distancia_um + 50) / 100;
+    printf("%s: %lu.%02lu cm", rotulo, (unsigned long)(centesimos / 100),
+           (unsigned long)(centesimos % 100));
 }
 
 int main()
 {
     stdio_init_all();
 
-    // Configura os pinos do sensor
-    gpio_init(PINO_TRIG);
-    gpio_set_dir(PINO_TRIG, GPIO_OUT);
-    gpio_put(PINO_TRIG, 0);
-
-    gpio_init(PINO_ECHO);
-    gpio_set_dir(PINO_ECHO, GPIO_IN);
-
     sleep_ms(1000); // Tempo para estabilização do sensor
 
-    // Loop contínuo para leitura e exibição da distância
+    // Configura a leitura contínua do sensor; outros sensores podem ser
+    // adicionados da mesma forma e são disparados ao mesmo tempo
+    ultrassom_init(PERIODO_US, LIMITE_ECO_US, NULL, NULL);
+    int sensor = ultrassom_adicionar(PINO_TRIG, PINO_ECHO);
+    if (sensor < 0)
+    {
+        printf("Sem máquina de estado livre para o sensor\n");
+        return 1;
+    }
+
+    // Loop contínuo para exibição da distância
     while (true)
     {
-        float distancia_cm = medir_distancia_cm();
-        printf("Distância: %.2f cm\n", distancia_cm);
+        ultrassom_leitura_t leitura;
+        if (ultrassom_ler((uint32_t)sensor, &leitura))
+        {
+            imprimir_distancia("Distância", leitura.distancia_um);
+            imprimir_distancia(" (sem filtro", leitura.bruta_um);
+            printf(", %lu medidas sem eco)\n", (unsigned long)leitura.sem_eco);
+        }
+        else
+        {
+            printf("Aguardando eco...\n");
+        }
         sleep_ms(500);
     }
 
@@ -1,5 +1,13 @@
 #include "scheduler.h"
 #include "console.h"
+#include "eventos_gpio.h"
+
+/**
+ * Botoes A e B da BitDogLab (ligados ao GND, com pull-up)
+ */
+#define PINO_BOTAO_A 5
+#define PINO_BOTAO_B 6
+#define DEBOUNCE_BOTAO_US 20000
 
 /**
  * Tarefa executada a cada 1 segundo
@@ -15,12 +23,83 @@ void tarefa_dois(void) {
     console_log("Tarefa 2 executando a cada 2 segundos");
 }
 
+/**
+ * Estado da corrotina de contagem (sobrevive entre as esperas)
+ */
+typedef struct {
+    int restantes;
+} contagem_t;
+
+/**
+ * Corrotina que escreve tres mensagens espacadas de 500 ms e termina
+ */
+corrotina_estado_t tarefa_contagem(corrotina_t *co, void *dados) {
+    contagem_t *contagem = (contagem_t *) dados;
+
+    CO_BEGIN(co);
+    while (contagem->restantes > 0) {
+        console_log("Corrotina aguardando 500 ms sem ocupar o core");
+        contagem->restantes--;
+        CO_AWAIT_US(co, 500000);
+    }
+    console_log("Corrotina terminou");
+    CO_END(co);
+}
+
+static tarefa_handle_t tarefa_botoes = TAREFA_HANDLE_INVALIDO;
+
+/**
+ * Chamado na IRQ a cada evento de botao: acorda a corrotina que os consome
+ */
+static void avisar_botoes(void *contexto) {
+    (void) contexto;
+    scheduler_notify(tarefa_botoes);
+}
+
+/**
+ * Consome os eventos dos botoes e dorme ate o proximo aviso
+ */
+corrotina_estado_t tratar_botoes(corrotina_t *co, void *dados) {
+    (void) dados;
+    evento_gpio_t evento;
+
+    CO_BEGIN(co);
+    while (true) {
+        while (eventos_gpio_proximo(&evento)) {
+            console_logf("Botao no pino %u %s em %lu us", evento.pino,
+                         evento.nivel ? "solto" : "pressionado", evento.instante_us);
+        }
+        CO_AWAIT_NOTIFY(co, 0);
+    }
+    CO_END(co);
+}
+
 int main() {
+    static contagem_t contagem = { .restantes = 3 };
+
     console_init();
     scheduler_init();
 
+    // Envia as mensagens do console fora das tarefas e IRQs que as geram
+    scheduler_add_task(console_flush, 10);
+
     scheduler_add_task(tarefa_um, 1000);
     scheduler_add_task(tarefa_dois, 2000);
+    scheduler_add_coroutine(tarefa_contagem, &contagem, SCHEDULER_CORE_QUALQUER);
+
+    // Bordas dos botoes por IRQ, com debounce; cada evento acorda a
+    // corrotina, que so le a fila (pull-ups antes de adicionar: o nivel de
+    // partida e lido ali)
+    tarefa_botoes = scheduler_add_coroutine(tratar_botoes, NULL, SCHEDULER_CORE_QUALQUER);
+    eventos_gpio_init();
+    eventos_gpio_set_aviso(avisar_botoes, NULL);
+    gpio_pull_up(PINO_BOTAO_A);
+    gpio_pull_up(PINO_BOTAO_B);
+    eventos_gpio_adicionar(PINO_BOTAO_A, DEBOUNCE_BOTAO_US);
+    eventos_gpio_adicionar(PINO_BOTAO_B, DEBOUNCE_BOTAO_US);
+
+    // Mostra tempos de execucao e atrasos de cada tarefa a cada 10 segundos
+    scheduler_set_stats_dump(10000);
 
     scheduler_start();
     return 0;
@@ -0,0 +1,143 @@
+#include "scheduler_interno.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#define SEM_ESPERA UINT16_MAX
+
+/**
+ * Corrotina que espera cada pino de GPIO e cada canal de DMA
+ * (uma por recurso)
+ */
+static uint16_t espera_gpio[NUM_BANK0_GPIOS];
+static uint16_t espera_dma[NUM_DMA_CHANNELS];
+
+/**
+ * Bordas pedidas pela corrotina que espera cada pino: outros handlers
+ * podem habilitar bordas a mais no mesmo pino
+ */
+static uint32_t bordas_esperadas[NUM_BANK0_GPIOS];
+
+/**
+ * Habilita/desabilita as bordas do pino na IRQ do core 0, qualquer que seja
+ * o core que registrou a espera (gpio_set_irq_enabled usa o core atual)
+ */
+static void irq_gpio_core0(uint gpio, uint32_t eventos, bool habilitar) {
+    io_rw_32 *inte = &io_bank0_hw->proc0_irq_ctrl.inte[gpio / 8];
+    uint32_t mascara = eventos << (4 * (gpio % 8));
+
+    if (habilitar) {
+        hw_set_bits(inte, mascara);
+    } else {
+        hw_clear_bits(inte, mascara);
+    }
+}
+
+/**
+ * Handler compartilhado de IO_IRQ_BANK0: trata apenas os pinos esperados
+ * por alguma corrotina e deixa os demais para os outros handlers
+ */
+static void irq_gpio(void) {
+    uint32_t salvo = scheduler_travar();
+
+    for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        uint16_t indice = espera_gpio[gpio];
+        if (indice == SEM_ESPERA) {
+            continue;
+        }
+
+        uint32_t eventos = gpio_get_irq_event_mask(gpio) & bordas_esperadas[gpio];
+        if (eventos) {
+            scheduler_acordar(indice);
+        }
+    }
+
+    scheduler_destravar(salvo);
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_1: acorda quem espera cada canal concluido
+ */
+static void irq_dma(void) {
+    uint32_t salvo = scheduler_travar();
+
+    for (uint canal = 0; canal < NUM_DMA_CHANNELS; canal++) {
+        uint16_t indice = espera_dma[canal];
+        if (indice != SEM_ESPERA && dma_channel_get_irq1_status(canal)) {
+            scheduler_acordar(indice);
+        }
+    }
+
+    scheduler_destravar(salvo);
+}
+
+void corrotina_init(void) {
+    for (uint i = 0; i < NUM_BANK0_GPIOS; i++) {
+        espera_gpio[i] = SEM_ESPERA;
+    }
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        espera_dma[i] = SEM_ESPERA;
+    }
+
+    // Ordem mais alta: as bordas esperadas sao reconhecidas antes do
+    // handler de callbacks de GPIO do SDK
+    irq_add_shared_handler(IO_IRQ_BANK0, irq_gpio, PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    irq_add_shared_handler(DMA_IRQ_1, irq_dma, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_1, true);
+}
+
+corrotina_registro_t corrotina_registrar_espera(uint16_t indice, const corrotina_t *co) {
+    if (co->espera == CORROTINA_ESPERA_GPIO) {
+        if (co->recurso >= NUM_BANK0_GPIOS || espera_gpio[co->recurso] != SEM_ESPERA) {
+            return CORROTINA_ESPERA_RECUSADA;
+        }
+
+        // Descarta bordas antigas: so contam as que chegarem a partir de agora
+        gpio_acknowledge_irq(co->recurso, co->eventos);
+        espera_gpio[co->recurso] = indice;
+        bordas_esperadas[co->recurso] = co->eventos;
+        irq_gpio_core0(co->recurso, co->eventos, true);
+        return CORROTINA_ESPERA_REGISTRADA;
+    }
+
+    if (co->espera == CORROTINA_ESPERA_DMA) {
+        if (co->recurso >= NUM_DMA_CHANNELS) {
+            return CORROTINA_ESPERA_RECUSADA;
+        }
+
+        // Se o canal ja terminou, nao ha o que esperar
+        if (!dma_channel_is_busy(co->recurso)) {
+            return CORROTINA_ESPERA_SATISFEITA;
+        }
+        if (espera_dma[co->recurso] != SEM_ESPERA) {
+            return CORROTINA_ESPERA_RECUSADA;
+        }
+
+        dma_channel_acknowledge_irq1(co->recurso);
+        espera_dma[co->recurso] = indice;
+        dma_channel_set_irq1_enabled(co->recurso, true);
+
+        // O canal pode ter terminado entre a consulta e a habilitacao da IRQ
+        if (!dma_channel_is_busy(co->recurso)) {
+            corrotina_cancelar_espera(co);
+            return CORROTINA_ESPERA_SATISFEITA;
+        }
+        return CORROTINA_ESPERA_REGISTRADA;
+    }
+
+    return CORROTINA_ESPERA_REGISTRADA;
+}
+
+void corrotina_cancelar_espera(const corrotina_t *co) {
+    if (co->espera == CORROTINA_ESPERA_GPIO && espera_gpio[co->recurso] != SEM_ESPERA) {
+        irq_gpio_core0(co->recurso, co->eventos, false);
+        gpio_acknowledge_irq(co->recurso, co->eventos);
+        espera_gpio[co->recurso] = SEM_ESPERA;
+    } else if (co->espera == CORROTINA_ESPERA_DMA && espera_dma[co->recurso] != SEM_ESPERA) {
+        dma_channel_set_irq1_enabled(co->recurso, false);
+        dma_channel_acknowledge_irq1(co->recurso);
+        espera_dma[co->recurso] = SEM_ESPERA;
+    }
+}
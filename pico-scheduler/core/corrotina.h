@@ -0,0 +1,143 @@
+#ifndef CORROTINA_H
+#define CORROTINA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Corrotinas sem pilha (no estilo protothreads) executadas pelo escalonador.
+ *
+ * Uma corrotina e uma funcao que retorna sempre que precisa esperar algo
+ * (tempo, borda de GPIO, fim de DMA ou scheduler_notify) e e retomada pelo escalonador no
+ * ponto em que parou quando a condicao acontece. Como nao ha pilha propria,
+ * variaveis locais NAO sobrevivem a uma espera: o estado deve ficar na
+ * estrutura passada como `dados`. Use no maximo um CO_AWAIT_* por linha,
+ * pois o ponto de retomada e identificado por __LINE__.
+ *
+ *   corrotina_estado_t piscar(corrotina_t *co, void *dados) {
+ *       estado_led_t *led = dados;
+ *       CO_BEGIN(co);
+ *       while (true) {
+ *           gpio_put(led->pino, led->aceso = !led->aceso);
+ *           CO_AWAIT_US(co, 500000);
+ *       }
+ *       CO_END(co);
+ *   }
+ */
+
+/**
+ * Valor de retorno de uma corrotina
+ */
+typedef enum {
+    CORROTINA_SUSPENSA = 0, // aguardando a condicao registrada
+    CORROTINA_TERMINADA,    // terminou; sua posicao no escalonador e liberada
+} corrotina_estado_t;
+
+/**
+ * Condicao pela qual a corrotina esta esperando
+ */
+typedef enum {
+    CORROTINA_ESPERA_NENHUMA = 0,
+    CORROTINA_ESPERA_TEMPO,
+    CORROTINA_ESPERA_GPIO,
+    CORROTINA_ESPERA_DMA,
+    CORROTINA_ESPERA_NOTIFICACAO,
+} corrotina_espera_t;
+
+/**
+ * Contexto de uma corrotina. Mantido pelo escalonador; a corrotina so
+ * deve consultar `expirou`.
+ */
+typedef struct {
+    uint16_t linha;      // ponto de retomada (__LINE__ do ultimo CO_AWAIT)
+    uint8_t espera;      // corrotina_espera_t
+    uint8_t recurso;     // pino de GPIO ou canal de DMA esperado
+    uint32_t eventos;    // bordas de GPIO esperadas (GPIO_IRQ_EDGE_*)
+    uint32_t tempo_us;   // duracao da espera, ou timeout (0 = sem timeout)
+    bool expirou;        // a ultima espera terminou por timeout ou foi recusada
+} corrotina_t;
+
+/**
+ * Funcao de uma corrotina
+ * @param co Contexto da corrotina
+ * @param dados Estado da tarefa, informado em scheduler_add_coroutine
+ */
+typedef corrotina_estado_t (*funcao_corrotina_t)(corrotina_t *co, void *dados);
+
+static inline void corrotina_esperar(corrotina_t *co, corrotina_espera_t espera,
+                                     uint8_t recurso, uint32_t eventos, uint32_t tempo_us) {
+    co->espera = (uint8_t) espera;
+    co->recurso = recurso;
+    co->eventos = eventos;
+    co->tempo_us = tempo_us;
+}
+
+#define CO_BEGIN(co) switch ((co)->linha) { case 0:
+
+#define CO_END(co) } (co)->linha = 0; return CORROTINA_TERMINADA
+
+/**
+ * Suspende a corrotina e registra a retomada no ponto atual
+ */
+#define CO_SUSPEND_(co)                 \
+    do {                                \
+        (co)->linha = __LINE__;         \
+        return CORROTINA_SUSPENSA;      \
+        case __LINE__:;                 \
+    } while (0)
+
+/**
+ * Espera `us` microssegundos sem ocupar o core
+ */
+#define CO_AWAIT_US(co, us)                                                   \
+    do {                                                                      \
+        corrotina_esperar((co), CORROTINA_ESPERA_TEMPO, 0, 0, (uint32_t) (us)); \
+        CO_SUSPEND_(co);                                                      \
+    } while (0)
+
+/**
+ * Devolve o core ao escalonador e volta assim que possivel
+ */
+#define CO_YIELD(co) CO_AWAIT_US(co, 0)
+
+/**
+ * Espera uma borda no pino (GPIO_IRQ_EDGE_RISE e/ou GPIO_IRQ_EDGE_FALL).
+ * Com timeout_us > 0, retoma apos o timeout com `co->expirou` verdadeiro.
+ * Um pino atende uma corrotina por vez: se outra ja o espera, retoma na
+ * hora com `co->expirou` verdadeiro.
+ */
+#define CO_AWAIT_GPIO_EDGE(co, gpio, eventos, timeout_us)                      \
+    do {                                                                      \
+        corrotina_esperar((co), CORROTINA_ESPERA_GPIO, (uint8_t) (gpio),       \
+                          (uint32_t) (eventos), (uint32_t) (timeout_us));     \
+        CO_SUSPEND_(co);                                                      \
+    } while (0)
+
+/**
+ * Espera o canal de DMA terminar a transferencia atual.
+ * Com timeout_us > 0, retoma apos o timeout com `co->expirou` verdadeiro.
+ * Um canal atende uma corrotina por vez: se outra ja o espera, retoma na
+ * hora com `co->expirou` verdadeiro.
+ */
+#define CO_AWAIT_DMA_DONE(co, canal, timeout_us)                               \
+    do {                                                                      \
+        corrotina_esperar((co), CORROTINA_ESPERA_DMA, (uint8_t) (canal), 0,    \
+                          (uint32_t) (timeout_us));                           \
+        CO_SUSPEND_(co);                                                      \
+    } while (0)
+
+/**
+ * Espera uma chamada de scheduler_notify para esta corrotina (por exemplo,
+ * de uma IRQ que produziu dados). Uma notificacao feita antes da espera
+ * fica pendente e faz esta retornar na hora; varias notificacoes pendentes
+ * valem por uma. Com timeout_us > 0, retoma apos o timeout com
+ * `co->expirou` verdadeiro.
+ */
+#define CO_AWAIT_NOTIFY(co, timeout_us)                                        \
+    do {                                                                      \
+        corrotina_esperar((co), CORROTINA_ESPERA_NOTIFICACAO, 0, 0,            \
+                          (uint32_t) (timeout_us));                           \
+        CO_SUSPEND_(co);                                                      \
+    } while (0)
+
+#endif
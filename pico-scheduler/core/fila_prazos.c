@@ -0,0 +1,134 @@
+#include "fila_prazos.h"
+
+#ifdef FILA_PRAZOS_CONTAR
+uint64_t fila_prazos_comparacoes = 0;
+#define CONTAR_COMPARACAO() (fila_prazos_comparacoes++)
+#else
+#define CONTAR_COMPARACAO() ((void) 0)
+#endif
+
+static void colocar(fila_prazos_t *fila, uint16_t indice, entrada_prazo_t entrada) {
+    fila->itens[indice] = entrada;
+    fila->posicao[entrada.id] = indice;
+}
+
+/**
+ * Sobe a entrada ate que o pai tenha prazo menor ou igual
+ */
+static void subir(fila_prazos_t *fila, uint16_t indice) {
+    entrada_prazo_t entrada = fila->itens[indice];
+
+    while (indice > 0) {
+        uint16_t pai = (uint16_t) ((indice - 1) / 2);
+        CONTAR_COMPARACAO();
+        if (fila->itens[pai].prazo_us <= entrada.prazo_us) {
+            break;
+        }
+        colocar(fila, indice, fila->itens[pai]);
+        indice = pai;
+    }
+
+    colocar(fila, indice, entrada);
+}
+
+/**
+ * Desce a entrada ate que os filhos tenham prazo maior ou igual
+ */
+static void descer(fila_prazos_t *fila, uint16_t indice) {
+    entrada_prazo_t entrada = fila->itens[indice];
+
+    while (true) {
+        uint32_t filho = 2u * indice + 1u;
+        if (filho >= fila->tamanho) {
+            break;
+        }
+        if (filho + 1u < fila->tamanho) {
+            CONTAR_COMPARACAO();
+            if (fila->itens[filho + 1u].prazo_us < fila->itens[filho].prazo_us) {
+                filho++;
+            }
+        }
+        CONTAR_COMPARACAO();
+        if (entrada.prazo_us <= fila->itens[filho].prazo_us) {
+            break;
+        }
+        colocar(fila, indice, fila->itens[filho]);
+        indice = (uint16_t) filho;
+    }
+
+    colocar(fila, indice, entrada);
+}
+
+void fila_prazos_init(fila_prazos_t *fila, entrada_prazo_t *itens,
+                      uint16_t *posicao, uint16_t capacidade) {
+    fila->itens = itens;
+    fila->posicao = posicao;
+    fila->capacidade = capacidade;
+    fila->tamanho = 0;
+
+    for (uint16_t i = 0; i < capacidade; i++) {
+        posicao[i] = FILA_PRAZOS_FORA;
+    }
+}
+
+bool fila_prazos_contem(const fila_prazos_t *fila, uint16_t id) {
+    return id < fila->capacidade && fila->posicao[id] != FILA_PRAZOS_FORA;
+}
+
+bool fila_prazos_inserir(fila_prazos_t *fila, uint16_t id, uint64_t prazo_us) {
+    if (id >= fila->capacidade || fila_prazos_contem(fila, id) ||
+        fila->tamanho >= fila->capacidade) {
+        return false;
+    }
+
+    uint16_t indice = fila->tamanho++;
+    colocar(fila, indice, (entrada_prazo_t) { .prazo_us = prazo_us, .id = id });
+    subir(fila, indice);
+    return true;
+}
+
+bool fila_prazos_topo(const fila_prazos_t *fila, entrada_prazo_t *entrada) {
+    if (fila->tamanho == 0) {
+        return false;
+    }
+
+    *entrada = fila->itens[0];
+    return true;
+}
+
+bool fila_prazos_remover_topo(fila_prazos_t *fila, entrada_prazo_t *entrada) {
+    if (fila->tamanho == 0) {
+        return false;
+    }
+
+    if (entrada) {
+        *entrada = fila->itens[0];
+    }
+    return fila_prazos_remover(fila, fila->itens[0].id);
+}
+
+bool fila_prazos_remover(fila_prazos_t *fila, uint16_t id) {
+    if (!fila_prazos_contem(fila, id)) {
+        return false;
+    }
+
+    uint16_t indice = fila->posicao[id];
+    uint16_t ultimo = --fila->tamanho;
+    fila->posicao[id] = FILA_PRAZOS_FORA;
+
+    if (indice == ultimo) {
+        return true;
+    }
+
+    // A ultima entrada ocupa o buraco e e reposicionada para cima ou para baixo
+    uint64_t prazo_removido = fila->itens[indice].prazo_us;
+    colocar(fila, indice, fila->itens[ultimo]);
+
+    CONTAR_COMPARACAO();
+    if (fila->itens[indice].prazo_us < prazo_removido) {
+        subir(fila, indice);
+    } else {
+        descer(fila, indice);
+    }
+    return true;
+}
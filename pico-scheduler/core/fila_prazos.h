@@ -0,0 +1,85 @@
+#ifndef FILA_PRAZOS_H
+#define FILA_PRAZOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Identificador usado quando um elemento nao esta na fila
+ */
+#define FILA_PRAZOS_FORA UINT16_MAX
+
+/**
+ * Entrada da fila: um identificador (indice da tarefa) e seu prazo
+ */
+typedef struct {
+    uint64_t prazo_us;
+    uint16_t id;
+} entrada_prazo_t;
+
+/**
+ * Fila de prioridade (min-heap binario) ordenada pelo menor prazo.
+ *
+ * O armazenamento e fornecido por quem chama, para que a fila nao dependa
+ * de alocacao dinamica. `posicao[id]` guarda onde cada id esta no heap,
+ * permitindo remover um id qualquer em O(log n).
+ */
+typedef struct {
+    entrada_prazo_t *itens;
+    uint16_t *posicao;
+    uint16_t capacidade;
+    uint16_t tamanho;
+} fila_prazos_t;
+
+/**
+ * Inicializa a fila sobre os vetores fornecidos
+ * @param fila Fila a ser inicializada
+ * @param itens Vetor com `capacidade` entradas
+ * @param posicao Vetor com `capacidade` posicoes (indexado pelo id)
+ * @param capacidade Numero maximo de ids (ids validos: 0 .. capacidade - 1)
+ */
+void fila_prazos_init(fila_prazos_t *fila, entrada_prazo_t *itens,
+                      uint16_t *posicao, uint16_t capacidade);
+
+/**
+ * Insere um id com o prazo informado, em O(log n)
+ * @return false se o id for invalido ou ja estiver na fila
+ */
+bool fila_prazos_inserir(fila_prazos_t *fila, uint16_t id, uint64_t prazo_us);
+
+/**
+ * Consulta a entrada de menor prazo sem remove-la, em O(1)
+ * @return false se a fila estiver vazia
+ */
+bool fila_prazos_topo(const fila_prazos_t *fila, entrada_prazo_t *entrada);
+
+/**
+ * Remove a entrada de menor prazo, em O(log n)
+ * @return false se a fila estiver vazia
+ */
+bool fila_prazos_remover_topo(fila_prazos_t *fila, entrada_prazo_t *entrada);
+
+/**
+ * Remove um id qualquer da fila, em O(log n)
+ * @return false se o id nao estiver na fila
+ */
+bool fila_prazos_remover(fila_prazos_t *fila, uint16_t id);
+
+/**
+ * Indica se o id esta atualmente na fila
+ */
+bool fila_prazos_contem(const fila_prazos_t *fila, uint16_t id);
+
+static inline bool fila_prazos_vazia(const fila_prazos_t *fila) {
+    return fila->tamanho == 0;
+}
+
+#ifdef FILA_PRAZOS_CONTAR
+/**
+ * Comparacoes de prazo feitas por todas as filas, para os testes do host
+ * (so existe quando compilado com FILA_PRAZOS_CONTAR)
+ */
+extern uint64_t fila_prazos_comparacoes;
+#endif
+
+#endif
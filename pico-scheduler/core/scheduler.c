@@ -1,64 +1,905 @@
+#include <string.h>
 #include "scheduler.h"
+#include "fila_prazos.h"
+#include "scheduler_interno.h"
 #include "pico/time.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
 #include "console.h"
 
-#define MAX_TAREFAS 4
+#define INDICE_NENHUM UINT16_MAX
+
+/**
+ * Filas de disparo: uma por core, uma compartilhada, da qual qualquer
+ * core ocioso retira tarefas sem afinidade, e uma para as tarefas
+ * preemptivas, despachadas pela IRQ de software do core 0
+ */
+#define FILA_CORE_0 0
+#define FILA_CORE_1 1
+#define FILA_COMPARTILHADA 2
+#define FILA_PREEMPTIVA 3
+#define TOTAL_FILAS 4
 
 /**
  * Estrutura que representa uma tarefa periodica
  */
 typedef struct {
     funcao_tarefa_t tarefa;
+    funcao_corrotina_t corrotina;
+    void *dados;
+    funcao_overrun_t gancho_overrun;
+    uint64_t proximo_disparo_us;
     uint32_t intervalo_ms;
-    repeating_timer_t temporizador;
+    uint32_t prazo_ms;
+    uint16_t geracao;
+    uint16_t proxima_livre;
+    uint8_t fila;
+    uint8_t prioridade;
+    uint8_t overrun;
     bool ativa;
+    bool notificada;          // scheduler_notify antes de CO_AWAIT_NOTIFY
+    bool aguarda_notificacao; // parada em CO_AWAIT_NOTIFY, fora das filas
+    tarefa_stats_t stats;
+    corrotina_t co;
 } tarefa_periodica_t;
 
-static tarefa_periodica_t tarefas[MAX_TAREFAS];
-static uint8_t total_tarefas = 0;
+/**
+ * Arena estatica de tarefas; as posicoes livres formam uma lista encadeada
+ */
+static tarefa_periodica_t tarefas[SCHEDULER_MAX_TASKS];
+static uint16_t primeira_livre = INDICE_NENHUM;
+static uint16_t total_tarefas = 0;
+
+static tarefa_handle_t tarefa_dump_stats = TAREFA_HANDLE_INVALIDO;
+
+/**
+ * Filas de proximos disparos, ordenadas pelo prazo mais proximo
+ */
+static entrada_prazo_t itens_fila[TOTAL_FILAS][SCHEDULER_MAX_TASKS];
+static uint16_t posicoes_fila[TOTAL_FILAS][SCHEDULER_MAX_TASKS];
+static fila_prazos_t filas[TOTAL_FILAS];
+
+/**
+ * Filas de tarefas ja liberadas e ainda nao executadas, ordenadas pela
+ * chave da politica de escalonamento (menor chave executa primeiro)
+ */
+static entrada_prazo_t itens_prontas[TOTAL_FILAS][SCHEDULER_MAX_TASKS];
+static uint16_t posicoes_prontas[TOTAL_FILAS][SCHEDULER_MAX_TASKS];
+static fila_prazos_t prontas[TOTAL_FILAS];
+
+static politica_escalonamento_t politica = SCHEDULER_POLITICA_PRIORIDADE;
+
+/**
+ * IRQ de software (user IRQ) usada para executar as tarefas preemptivas
+ */
+static int irq_preemptiva = -1;
+static volatile bool tem_preemptivas = false;
+
+/**
+ * Spinlock de hardware que protege a arena e as filas entre os dois cores
+ * (tambem desabilita as interrupcoes do core que o detem)
+ */
+static spin_lock_t *trava;
+
+/**
+ * Um unico alarme de hardware, armado para o prazo mais proximo entre
+ * todos os cores que estao aguardando
+ */
+static alarm_id_t alarme = 0;
+static uint64_t prazo_alarme_us = 0;
+
+/**
+ * Tempo ocioso de cada core, medido em torno do __wfe() do despachante
+ */
+static scheduler_uso_core_t uso_cores[SCHEDULER_NUM_CORES];
+static uint64_t inicio_medicao_us[SCHEDULER_NUM_CORES];
+
+static tarefa_handle_t criar_handle(uint16_t indice) {
+    return ((tarefa_handle_t) tarefas[indice].geracao << 16) | indice;
+}
 
 /**
- * Callback executado automaticamente pelo timer do Pico SDK
+ * Converte um handle na posicao da arena
+ * @return INDICE_NENHUM se o handle nao corresponder a uma tarefa ativa
  */
-static bool callback_tarefa(repeating_timer_t *rt) {
-    tarefa_periodica_t *tarefa_atual = (tarefa_periodica_t *) rt->user_data;
+static uint16_t indice_do_handle(tarefa_handle_t handle) {
+    uint16_t indice = (uint16_t) (handle & 0xffffu);
+    uint16_t geracao = (uint16_t) (handle >> 16);
 
-    if (tarefa_atual && tarefa_atual->tarefa) {
-        tarefa_atual->tarefa();
+    if (handle == TAREFA_HANDLE_INVALIDO || indice >= SCHEDULER_MAX_TASKS) {
+        return INDICE_NENHUM;
     }
+    if (!tarefas[indice].ativa || tarefas[indice].geracao != geracao) {
+        return INDICE_NENHUM;
+    }
+    return indice;
+}
 
-    return true;
+/**
+ * Converte a afinidade pedida na fila onde a tarefa sera agendada
+ */
+static uint8_t fila_da_afinidade(afinidade_core_t core) {
+    switch (core) {
+        case SCHEDULER_CORE_0:
+            return FILA_CORE_0;
+        case SCHEDULER_CORE_1:
+            // Sem o core 1 no escalonador, a tarefa fica com o core 0
+            return SCHEDULER_NUM_CORES > 1 ? FILA_CORE_1 : FILA_CORE_0;
+        default:
+            return FILA_COMPARTILHADA;
+    }
+}
+
+/**
+ * Retira uma posicao da lista de livres, em O(1)
+ */
+static uint16_t alocar_posicao(void) {
+    uint16_t indice = primeira_livre;
+
+    if (indice != INDICE_NENHUM) {
+        primeira_livre = tarefas[indice].proxima_livre;
+        tarefas[indice].proxima_livre = INDICE_NENHUM;
+    }
+    return indice;
+}
+
+/**
+ * Devolve uma posicao a lista de livres, em O(1)
+ */
+static void liberar_posicao(uint16_t indice) {
+    tarefas[indice].ativa = false;
+    tarefas[indice].tarefa = NULL;
+    tarefas[indice].corrotina = NULL;
+
+    // A geracao nunca volta a zero, para que o handle 0 continue invalido
+    if (++tarefas[indice].geracao == 0) {
+        tarefas[indice].geracao = 1;
+    }
+
+    tarefas[indice].proxima_livre = primeira_livre;
+    primeira_livre = indice;
+}
+
+static void zerar_stats(tarefa_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->exec_min_us = UINT32_MAX;
+}
+
+/**
+ * Faixa do histograma: numero de bits significativos da latencia
+ */
+static uint32_t faixa_latencia(uint32_t latencia_us) {
+    uint32_t faixa = 0;
+
+    while (latencia_us && faixa < SCHEDULER_STATS_BUCKETS - 1) {
+        latencia_us >>= 1;
+        faixa++;
+    }
+    return faixa;
+}
+
+/**
+ * Registra uma execucao nas estatisticas da tarefa
+ * @param prazo_us Prazo relativo a liberacao; 0 nao verifica prazo
+ */
+static void registrar_execucao(tarefa_stats_t *stats, uint64_t liberacao_us,
+                               uint64_t inicio_us, uint64_t fim_us, uint64_t prazo_us) {
+    uint32_t latencia_us = (uint32_t) (inicio_us - liberacao_us);
+    uint32_t exec_us = (uint32_t) (fim_us - inicio_us);
+
+    stats->execucoes++;
+    stats->exec_total_us += exec_us;
+    if (exec_us < stats->exec_min_us) {
+        stats->exec_min_us = exec_us;
+    }
+    if (exec_us > stats->exec_max_us) {
+        stats->exec_max_us = exec_us;
+    }
+    if (latencia_us > stats->jitter_max_us) {
+        stats->jitter_max_us = latencia_us;
+    }
+    if (prazo_us && fim_us > liberacao_us + prazo_us) {
+        stats->prazos_perdidos++;
+    }
+    stats->histograma_latencia[faixa_latencia(latencia_us)]++;
+}
+
+/**
+ * Chave de ordenacao de uma tarefa liberada, conforme a politica atual
+ */
+static uint64_t chave_pronta(const tarefa_periodica_t *tarefa) {
+    uint64_t liberacao_us = tarefa->proximo_disparo_us;
+
+    switch (politica) {
+        case SCHEDULER_POLITICA_RM:
+            // Menor periodo primeiro; a prioridade desempata
+            return ((uint64_t) tarefa->intervalo_ms << 8) | (uint8_t) (255u - tarefa->prioridade);
+        case SCHEDULER_POLITICA_EDF:
+            return liberacao_us + (uint64_t) tarefa->prazo_ms * 1000u;
+        default:
+            // Maior prioridade primeiro; a ordem de liberacao desempata
+            return ((uint64_t) (255u - tarefa->prioridade) << 56) |
+                   (liberacao_us & ((UINT64_C(1) << 56) - 1));
+    }
+}
+
+/**
+ * Move as tarefas com disparo vencido para a fila de prontas. Chamada com a trava.
+ */
+static void liberar_vencidas(uint8_t fila, uint64_t agora_us) {
+    entrada_prazo_t proxima;
+
+    while (fila_prazos_topo(&filas[fila], &proxima) && proxima.prazo_us <= agora_us) {
+        fila_prazos_remover_topo(&filas[fila], NULL);
+        fila_prazos_inserir(&prontas[fila], proxima.id, chave_pronta(&tarefas[proxima.id]));
+    }
+}
+
+/**
+ * Escolhe a pronta de menor chave entre a fila do core e a compartilhada
+ * e a retira da fila. Chamada com a trava.
+ * @return INDICE_NENHUM se nao houver tarefa pronta
+ */
+static uint16_t retirar_pronta(uint8_t fila_core) {
+    entrada_prazo_t propria;
+    entrada_prazo_t compartilhada;
+    bool tem_propria = fila_prazos_topo(&prontas[fila_core], &propria);
+    bool tem_compartilhada = fila_core != FILA_PREEMPTIVA &&
+                             fila_prazos_topo(&prontas[FILA_COMPARTILHADA], &compartilhada);
+
+    if (tem_propria && (!tem_compartilhada || propria.prazo_us <= compartilhada.prazo_us)) {
+        fila_prazos_remover_topo(&prontas[fila_core], NULL);
+        return propria.id;
+    }
+    if (tem_compartilhada) {
+        fila_prazos_remover_topo(&prontas[FILA_COMPARTILHADA], NULL);
+        return compartilhada.id;
+    }
+    return INDICE_NENHUM;
+}
+
+/**
+ * Callback do alarme: apenas acorda os despachantes, que rodam fora da IRQ
+ */
+static int64_t callback_alarme(alarm_id_t id, void *user_data) {
+    (void) user_data;
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    if (id == alarme) {
+        alarme = 0;
+    }
+    spin_unlock(trava, salvo);
+
+    // As tarefas preemptivas sao despachadas pela IRQ de software, que
+    // interrompe a tarefa comum em execucao no core 0
+    if (tem_preemptivas) {
+        irq_set_pending((uint) irq_preemptiva);
+    }
+
+    // Acorda os dois cores do __wfe()
+    __sev();
+    return 0;
+}
+
+/**
+ * Garante que o alarme dispare ate o prazo informado. Chamada com a trava.
+ * @return false se o prazo ja passou
+ */
+static bool armar_alarme(uint64_t prazo_us) {
+    // O alarme ja armado atende este prazo (o core acorda antes e reavalia)
+    if (alarme > 0 && prazo_alarme_us <= prazo_us) {
+        return true;
+    }
+
+    if (alarme > 0) {
+        cancel_alarm(alarme);
+        alarme = 0;
+    }
+
+    alarme = add_alarm_at(from_us_since_boot(prazo_us), callback_alarme, NULL, false);
+    prazo_alarme_us = prazo_us;
+    return alarme > 0;
+}
+
+/**
+ * Consulta o proximo disparo visivel para um core: sua propria fila e a
+ * compartilhada. Chamada com a trava.
+ * @return false se nao houver tarefas para este core
+ */
+static bool proxima_do_core(uint core, entrada_prazo_t *proxima, uint8_t *fila) {
+    entrada_prazo_t propria;
+    entrada_prazo_t compartilhada;
+    bool tem_propria = fila_prazos_topo(&filas[core], &propria);
+    bool tem_compartilhada = fila_prazos_topo(&filas[FILA_COMPARTILHADA], &compartilhada);
+
+    // Em empate, a fila propria do core tem preferencia
+    if (tem_propria && (!tem_compartilhada || propria.prazo_us <= compartilhada.prazo_us)) {
+        *proxima = propria;
+        *fila = (uint8_t) core;
+        return true;
+    }
+    if (tem_compartilhada) {
+        *proxima = compartilhada;
+        *fila = FILA_COMPARTILHADA;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Registra a espera de GPIO, DMA ou notificacao. Chamada com a trava.
+ */
+static corrotina_registro_t registrar_espera(uint16_t indice) {
+    tarefa_periodica_t *tarefa = &tarefas[indice];
+
+    if (tarefa->co.espera != CORROTINA_ESPERA_NOTIFICACAO) {
+        return corrotina_registrar_espera(indice, &tarefa->co);
+    }
+
+    if (tarefa->notificada) {
+        tarefa->notificada = false;
+        return CORROTINA_ESPERA_SATISFEITA;
+    }
+    tarefa->aguarda_notificacao = true;
+    return CORROTINA_ESPERA_REGISTRADA;
+}
+
+/**
+ * Aplica a espera pedida pela corrotina ao suspender. Chamada com a trava.
+ */
+static void agendar_corrotina(uint16_t indice, uint64_t agora_us) {
+    tarefa_periodica_t *tarefa = &tarefas[indice];
+    corrotina_t *co = &tarefa->co;
+    uint64_t prazo_us = agora_us + co->tempo_us;
+
+    if (co->espera == CORROTINA_ESPERA_TEMPO) {
+        co->espera = CORROTINA_ESPERA_NENHUMA;
+    } else {
+        corrotina_registro_t registro = registrar_espera(indice);
+
+        if (registro != CORROTINA_ESPERA_REGISTRADA) {
+            // Condicao ja satisfeita, ou recurso ocupado por outra corrotina
+            // (retoma imediatamente como se a espera tivesse expirado)
+            co->espera = CORROTINA_ESPERA_NENHUMA;
+            co->expirou = registro == CORROTINA_ESPERA_RECUSADA;
+            prazo_us = agora_us;
+        } else if (co->tempo_us == 0) {
+            // Sem timeout: so a IRQ da condicao recoloca a corrotina na fila
+            return;
+        }
+    }
+
+    // Para esperas de GPIO/DMA, esta entrada na fila e o timeout
+    tarefa->proximo_disparo_us = prazo_us;
+    fila_prazos_inserir(&filas[tarefa->fila], indice, prazo_us);
+}
+
+/**
+ * Retoma uma corrotina e registra a proxima espera
+ */
+static void retomar_corrotina(uint16_t indice) {
+    tarefa_periodica_t *tarefa_atual = &tarefas[indice];
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    funcao_corrotina_t corrotina = tarefa_atual->ativa ? tarefa_atual->corrotina : NULL;
+    uint16_t geracao = tarefa_atual->geracao;
+    uint64_t liberacao_us = tarefa_atual->proximo_disparo_us;
+
+    // Saiu da fila pelo timeout com a espera de GPIO/DMA ainda registrada
+    if (tarefa_atual->co.espera != CORROTINA_ESPERA_NENHUMA) {
+        corrotina_cancelar_espera(&tarefa_atual->co);
+        tarefa_atual->aguarda_notificacao = false;
+        tarefa_atual->co.espera = CORROTINA_ESPERA_NENHUMA;
+        tarefa_atual->co.expirou = true;
+    }
+    spin_unlock(trava, salvo);
+
+    if (!corrotina) {
+        return;
+    }
+
+    uint64_t inicio_us = time_us_64();
+
+    corrotina_estado_t estado = corrotina(&tarefa_atual->co, tarefa_atual->dados);
+
+    uint64_t fim_us = time_us_64();
+
+    salvo = spin_lock_blocking(trava);
+
+    if (tarefa_atual->ativa && tarefa_atual->geracao == geracao) {
+        registrar_execucao(&tarefa_atual->stats, liberacao_us, inicio_us, fim_us, 0);
+
+        if (estado == CORROTINA_TERMINADA) {
+            liberar_posicao(indice);
+            total_tarefas--;
+        } else {
+            agendar_corrotina(indice, fim_us);
+        }
+    }
+
+    spin_unlock(trava, salvo);
+}
+
+/**
+ * Executa a tarefa retirada da fila e agenda seu proximo disparo
+ */
+static void despachar(uint16_t indice) {
+    if (tarefas[indice].corrotina) {
+        retomar_corrotina(indice);
+        return;
+    }
+
+    tarefa_periodica_t *tarefa_atual = &tarefas[indice];
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    funcao_tarefa_t funcao = tarefa_atual->ativa ? tarefa_atual->tarefa : NULL;
+    uint16_t geracao = tarefa_atual->geracao;
+    uint64_t liberacao_us = tarefa_atual->proximo_disparo_us;
+    uint64_t intervalo_us = (uint64_t) tarefa_atual->intervalo_ms * 1000u;
+    uint64_t prazo_us = (uint64_t) tarefa_atual->prazo_ms * 1000u;
+    spin_unlock(trava, salvo);
+
+    if (!funcao) {
+        return;
+    }
+
+    uint64_t inicio_us = time_us_64();
+
+    funcao();
+
+    uint64_t fim_us = time_us_64();
+
+    funcao_overrun_t gancho = NULL;
+    tarefa_handle_t handle = TAREFA_HANDLE_INVALIDO;
+    uint32_t atraso_us = 0;
+
+    salvo = spin_lock_blocking(trava);
+
+    // A tarefa pode ter se removido (ou sido removida pelo outro core) durante a execucao
+    if (tarefa_atual->ativa && tarefa_atual->geracao == geracao) {
+        registrar_execucao(&tarefa_atual->stats, liberacao_us, inicio_us, fim_us, prazo_us);
+
+        // Mantem a grade de disparos fixa, sem acumular o atraso de cada execucao
+        uint64_t proximo_us = liberacao_us + intervalo_us;
+
+        // Overrun: a execucao passou do disparo seguinte
+        if (fim_us > proximo_us && intervalo_us > 0 &&
+            tarefa_atual->overrun != SCHEDULER_OVERRUN_EM_SEQUENCIA) {
+            uint64_t pulados = (fim_us - proximo_us) / intervalo_us + 1u;
+
+            atraso_us = (uint32_t) (fim_us - proximo_us);
+            proximo_us += pulados * intervalo_us;
+            tarefa_atual->stats.disparos_pulados += (uint32_t) pulados;
+
+            if (tarefa_atual->overrun == SCHEDULER_OVERRUN_GANCHO) {
+                gancho = tarefa_atual->gancho_overrun;
+                handle = criar_handle(indice);
+            }
+        }
+
+        tarefa_atual->proximo_disparo_us = proximo_us;
+        fila_prazos_inserir(&filas[tarefa_atual->fila], indice, proximo_us);
+    }
+
+    spin_unlock(trava, salvo);
+
+    if (gancho) {
+        gancho(handle, atraso_us);
+    }
+}
+
+/**
+ * Laco de despacho de um core: executa as tarefas vencidas da propria fila
+ * e da fila compartilhada, e dorme em __wfe() ate o proximo prazo
+ */
+static void despachante(uint core) {
+    uint64_t ocioso_desde_us = 0;
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    inicio_medicao_us[core] = time_us_64();
+    spin_unlock(trava, salvo);
+
+    while (true) {
+        entrada_prazo_t proxima;
+        uint8_t fila;
+
+        salvo = spin_lock_blocking(trava);
+        uint64_t agora_us = time_us_64();
+
+        // Contabiliza o periodo dormindo que acabou de terminar
+        if (ocioso_desde_us) {
+            uso_cores[core].ocioso_us += agora_us - ocioso_desde_us;
+            uso_cores[core].despertares++;
+            ocioso_desde_us = 0;
+        }
+
+        liberar_vencidas((uint8_t) core, agora_us);
+        liberar_vencidas(FILA_COMPARTILHADA, agora_us);
+
+        // Entre as liberadas, executa primeiro a escolhida pela politica
+        uint16_t indice = retirar_pronta((uint8_t) core);
+        if (indice != INDICE_NENHUM) {
+            spin_unlock(trava, salvo);
+            despachar(indice);
+            continue;
+        }
+
+        bool tem_tarefa = proxima_do_core(core, &proxima, &fila);
+        if (tem_tarefa && proxima.prazo_us <= time_us_64()) {
+            spin_unlock(trava, salvo);
+            continue;
+        }
+
+        // Aguarda o alarme do prazo mais proximo; se ele ja passou, despacha direto
+        bool aguardar = !tem_tarefa || armar_alarme(proxima.prazo_us);
+        spin_unlock(trava, salvo);
+
+        // Dorme ate o alarme do proximo prazo ou o __sev() de uma tarefa
+        // nova/reagendada; nenhum tick periodico acorda o core no meio
+        if (aguardar) {
+            ocioso_desde_us = time_us_64();
+            __wfe();
+        }
+    }
+}
+
+/**
+ * Handler da IRQ de software do core 0: executa as tarefas preemptivas
+ * vencidas, na ordem da politica, e arma o alarme para a proxima
+ */
+static void despachante_preemptivo(void) {
+    while (true) {
+        entrada_prazo_t proxima;
+
+        uint32_t salvo = spin_lock_blocking(trava);
+        liberar_vencidas(FILA_PREEMPTIVA, time_us_64());
+
+        uint16_t indice = retirar_pronta(FILA_PREEMPTIVA);
+        if (indice != INDICE_NENHUM) {
+            spin_unlock(trava, salvo);
+            despachar(indice);
+            continue;
+        }
+
+        // Se o proximo disparo ja passou, o alarme nao e armado e o laco continua
+        bool pronto = !fila_prazos_topo(&filas[FILA_PREEMPTIVA], &proxima) ||
+                      armar_alarme(proxima.prazo_us);
+        spin_unlock(trava, salvo);
+
+        if (pronto) {
+            return;
+        }
+    }
+}
+
+#if SCHEDULER_NUM_CORES > 1
+/**
+ * Ponto de entrada do core 1
+ */
+static void despachante_core1(void) {
+    despachante(1);
+}
+#endif
+
+uint32_t scheduler_travar(void) {
+    return spin_lock_blocking(trava);
+}
+
+void scheduler_destravar(uint32_t salvo) {
+    spin_unlock(trava, salvo);
+}
+
+void scheduler_acordar(uint16_t indice) {
+    tarefa_periodica_t *tarefa = &tarefas[indice];
+
+    if (!tarefa->ativa || tarefa->co.espera == CORROTINA_ESPERA_NENHUMA) {
+        return;
+    }
+
+    corrotina_cancelar_espera(&tarefa->co);
+    tarefa->co.espera = CORROTINA_ESPERA_NENHUMA;
+    tarefa->co.expirou = false;
+
+    // Troca a entrada de timeout (se houver) por uma liberacao imediata
+    fila_prazos_remover(&filas[tarefa->fila], indice);
+    tarefa->proximo_disparo_us = time_us_64();
+    fila_prazos_inserir(&filas[tarefa->fila], indice, tarefa->proximo_disparo_us);
+
+    __sev();
 }
 
 void scheduler_init(void) {
     console_log("Escalonador inicializado");
+
+    trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+
     total_tarefas = 0;
+    tarefa_dump_stats = TAREFA_HANDLE_INVALIDO;
+    for (uint i = 0; i < TOTAL_FILAS; i++) {
+        fila_prazos_init(&filas[i], itens_fila[i], posicoes_fila[i], SCHEDULER_MAX_TASKS);
+        fila_prazos_init(&prontas[i], itens_prontas[i], posicoes_prontas[i], SCHEDULER_MAX_TASKS);
+    }
+
+    corrotina_init();
+
+    // Prioridade mais baixa: interrompe apenas o codigo em modo thread do core 0
+    irq_preemptiva = user_irq_claim_unused(true);
+    irq_set_exclusive_handler((uint) irq_preemptiva, despachante_preemptivo);
+    irq_set_priority((uint) irq_preemptiva, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled((uint) irq_preemptiva, true);
+
+    primeira_livre = INDICE_NENHUM;
+    for (int i = SCHEDULER_MAX_TASKS - 1; i >= 0; i--) {
+        tarefas[i].ativa = false;
+        tarefas[i].tarefa = NULL;
+        tarefas[i].corrotina = NULL;
+        tarefas[i].geracao = 1;
+        tarefas[i].proxima_livre = primeira_livre;
+        primeira_livre = (uint16_t) i;
+    }
+}
+
+void scheduler_set_policy(politica_escalonamento_t nova_politica) {
+    politica = nova_politica;
 }
 
-void scheduler_add_task(funcao_tarefa_t tarefa, uint32_t intervalo_ms) {
-    if (total_tarefas >= MAX_TAREFAS) {
+tarefa_config_t scheduler_task_config(funcao_tarefa_t tarefa, uint32_t intervalo_ms) {
+    tarefa_config_t config = {
+        .tarefa = tarefa,
+        .intervalo_ms = intervalo_ms,
+        .core = SCHEDULER_CORE_QUALQUER,
+    };
+    return config;
+}
+
+tarefa_handle_t scheduler_add_task_config(const tarefa_config_t *config) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint16_t indice = alocar_posicao();
+
+    if (indice == INDICE_NENHUM) {
+        spin_unlock(trava, salvo);
         console_log("Erro: limite maximo de tarefas atingido");
-        return;
+        return TAREFA_HANDLE_INVALIDO;
+    }
+
+    tarefa_periodica_t *nova = &tarefas[indice];
+    nova->tarefa = config->tarefa;
+    nova->intervalo_ms = config->intervalo_ms;
+    nova->prazo_ms = config->prazo_ms ? config->prazo_ms : config->intervalo_ms;
+    nova->prioridade = config->prioridade;
+    nova->overrun = (uint8_t) config->overrun;
+    nova->gancho_overrun = config->gancho_overrun;
+    nova->proximo_disparo_us = time_us_64() + (uint64_t) config->intervalo_ms * 1000u;
+    nova->fila = config->preemptiva ? FILA_PREEMPTIVA : fila_da_afinidade(config->core);
+    nova->ativa = true;
+    zerar_stats(&nova->stats);
+
+    fila_prazos_inserir(&filas[nova->fila], indice, nova->proximo_disparo_us);
+
+    // Tarefas preemptivas dependem do alarme para disparar a IRQ de software
+    if (config->preemptiva) {
+        tem_preemptivas = true;
+        armar_alarme(nova->proximo_disparo_us);
+    }
+
+    total_tarefas++;
+    tarefa_handle_t handle = criar_handle(indice);
+    spin_unlock(trava, salvo);
+
+    // Um core aguardando um prazo mais distante precisa reavaliar suas filas
+    __sev();
+    return handle;
+}
+
+tarefa_handle_t scheduler_add_coroutine(funcao_corrotina_t corrotina, void *dados,
+                                        afinidade_core_t core) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint16_t indice = alocar_posicao();
+
+    if (indice == INDICE_NENHUM) {
+        spin_unlock(trava, salvo);
+        console_log("Erro: limite maximo de tarefas atingido");
+        return TAREFA_HANDLE_INVALIDO;
     }
 
-    tarefas[total_tarefas].tarefa = tarefa;
-    tarefas[total_tarefas].intervalo_ms = intervalo_ms;
-    tarefas[total_tarefas].ativa = true;
+    tarefa_periodica_t *nova = &tarefas[indice];
+    nova->corrotina = corrotina;
+    nova->dados = dados;
+    nova->intervalo_ms = 0;
+    nova->prazo_ms = 0;
+    nova->prioridade = 0;
+    nova->overrun = SCHEDULER_OVERRUN_EM_SEQUENCIA;
+    nova->gancho_overrun = NULL;
+    nova->proximo_disparo_us = time_us_64();
+    nova->fila = fila_da_afinidade(core);
+    nova->ativa = true;
+    nova->notificada = false;
+    nova->aguarda_notificacao = false;
+    memset(&nova->co, 0, sizeof(nova->co));
+    zerar_stats(&nova->stats);
 
-    add_repeating_timer_ms(
-        intervalo_ms,
-        callback_tarefa,
-        &tarefas[total_tarefas],
-        &tarefas[total_tarefas].temporizador
-    );
+    // A corrotina comeca a executar assim que um core estiver livre
+    fila_prazos_inserir(&filas[nova->fila], indice, nova->proximo_disparo_us);
 
     total_tarefas++;
+    tarefa_handle_t handle = criar_handle(indice);
+    spin_unlock(trava, salvo);
+
+    __sev();
+    return handle;
+}
+
+bool scheduler_notify(tarefa_handle_t handle) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint16_t indice = indice_do_handle(handle);
+    bool valida = indice != INDICE_NENHUM && tarefas[indice].corrotina;
+
+    if (valida) {
+        tarefa_periodica_t *tarefa = &tarefas[indice];
+
+        // So acorda se a espera ja foi registrada; durante a execucao da
+        // corrotina a notificacao fica pendente
+        if (tarefa->aguarda_notificacao) {
+            tarefa->aguarda_notificacao = false;
+            scheduler_acordar(indice);
+        } else {
+            tarefa->notificada = true;
+        }
+    }
+
+    spin_unlock(trava, salvo);
+    return valida;
+}
+
+tarefa_handle_t scheduler_add_task(funcao_tarefa_t tarefa, uint32_t intervalo_ms) {
+    tarefa_config_t config = scheduler_task_config(tarefa, intervalo_ms);
+    return scheduler_add_task_config(&config);
+}
+
+bool scheduler_remove_task(tarefa_handle_t handle) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint16_t indice = indice_do_handle(handle);
+
+    if (indice == INDICE_NENHUM) {
+        spin_unlock(trava, salvo);
+        return false;
+    }
+
+    // Se a tarefa estiver em execucao ela ja saiu da fila; despachar() nao a reinsere
+    if (tarefas[indice].corrotina) {
+        corrotina_cancelar_espera(&tarefas[indice].co);
+        tarefas[indice].aguarda_notificacao = false;
+        tarefas[indice].co.espera = CORROTINA_ESPERA_NENHUMA;
+    }
+    fila_prazos_remover(&filas[tarefas[indice].fila], indice);
+    fila_prazos_remover(&prontas[tarefas[indice].fila], indice);
+    liberar_posicao(indice);
+
+    total_tarefas--;
+    spin_unlock(trava, salvo);
+    return true;
+}
+
+bool scheduler_get_stats(tarefa_handle_t handle, tarefa_stats_t *stats) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint16_t indice = indice_do_handle(handle);
+    bool encontrada = indice != INDICE_NENHUM && stats;
+
+    if (encontrada) {
+        *stats = tarefas[indice].stats;
+    }
+
+    spin_unlock(trava, salvo);
+    return encontrada;
+}
+
+bool scheduler_get_core_usage(unsigned int core, scheduler_uso_core_t *uso) {
+    if (core >= SCHEDULER_NUM_CORES || !uso) {
+        return false;
+    }
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    *uso = uso_cores[core];
+
+    // So ha medicao depois que o despachante do core comecou
+    if (inicio_medicao_us[core]) {
+        uint64_t decorrido_us = time_us_64() - inicio_medicao_us[core];
+        uso->ativo_us = decorrido_us > uso->ocioso_us ? decorrido_us - uso->ocioso_us : 0;
+    }
+    spin_unlock(trava, salvo);
+    return true;
+}
+
+void scheduler_reset_stats(void) {
+    uint32_t salvo = spin_lock_blocking(trava);
+
+    for (uint16_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        zerar_stats(&tarefas[i].stats);
+    }
+
+    for (uint core = 0; core < SCHEDULER_NUM_CORES; core++) {
+        memset(&uso_cores[core], 0, sizeof(uso_cores[core]));
+        if (inicio_medicao_us[core]) {
+            inicio_medicao_us[core] = time_us_64();
+        }
+    }
+
+    spin_unlock(trava, salvo);
+}
+
+void scheduler_dump_stats(void) {
+    static const char *nomes_filas[TOTAL_FILAS] = { "core 0", "core 1", "qualquer", "preemptiva" };
+
+    // console_logf guarda so os argumentos; os formatos precisam ser constantes
+    static const char *formatos_latencia[] = {
+        "  latencia[%lu]: %lu",
+        "  latencia[%lu]: %lu %lu",
+        "  latencia[%lu]: %lu %lu %lu",
+        "  latencia[%lu]: %lu %lu %lu %lu",
+    };
+    const uint32_t faixas_por_linha = count_of(formatos_latencia);
+
+    for (uint core = 0; core < SCHEDULER_NUM_CORES; core++) {
+        scheduler_uso_core_t uso;
+        scheduler_get_core_usage(core, &uso);
+
+        // Tempos em ms para caber em argumentos de 32 bits
+        uint32_t permil = scheduler_uso_ocioso_permil(&uso);
+        console_logf("Core %u: ocioso %lu.%lu%% (%lu/%lu ms) despertares=%lu",
+                     core, permil / 10, permil % 10,
+                     (uint32_t) (uso.ocioso_us / 1000), (uint32_t) (uso.ativo_us / 1000),
+                     uso.despertares);
+    }
+
+    for (uint16_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        // Copia sob a trava; a escrita acontece fora dela
+        uint32_t salvo = spin_lock_blocking(trava);
+        bool ativa = tarefas[i].ativa;
+        uint32_t intervalo_ms = tarefas[i].intervalo_ms;
+        uint8_t fila = tarefas[i].fila;
+        tarefa_stats_t copia = tarefas[i].stats;
+        spin_unlock(trava, salvo);
+
+        const tarefa_stats_t *stats = &copia;
+
+        if (!ativa || stats->execucoes == 0) {
+            continue;
+        }
+
+        console_logf("Tarefa %u (%lu ms, %s): n=%lu exec=%lu/%lu/%lu us",
+                     i, intervalo_ms, nomes_filas[fila], stats->execucoes,
+                     stats->exec_min_us, tarefa_stats_media_us(stats), stats->exec_max_us);
+        console_logf("  jitter max=%lu us perdidos=%lu pulados=%lu",
+                     stats->jitter_max_us, stats->prazos_perdidos, stats->disparos_pulados);
+
+        // Histograma: uma contagem por faixa de latencia (0, 1, 2-3, 4-7 us, ...)
+        const uint32_t *h = stats->histograma_latencia;
+        for (uint32_t faixa = 0; faixa < SCHEDULER_STATS_BUCKETS; faixa += faixas_por_linha) {
+            uint32_t n = MIN(faixas_por_linha, SCHEDULER_STATS_BUCKETS - faixa);
+            console_logf(formatos_latencia[n - 1], faixa, h[faixa],
+                         n > 1 ? h[faixa + 1] : 0, n > 2 ? h[faixa + 2] : 0,
+                         n > 3 ? h[faixa + 3] : 0);
+        }
+    }
+}
+
+tarefa_handle_t scheduler_set_stats_dump(uint32_t periodo_ms) {
+    scheduler_remove_task(tarefa_dump_stats);
+    tarefa_dump_stats = TAREFA_HANDLE_INVALIDO;
+
+    if (periodo_ms > 0) {
+        tarefa_dump_stats = scheduler_add_task(scheduler_dump_stats, periodo_ms);
+    }
+    return tarefa_dump_stats;
 }
 
 void scheduler_start(void) {
     console_log("Escalonador em execucao");
 
-    while (true) {
-        tight_loop_contents();
-    }
-}
\ No newline at end of file
+#if SCHEDULER_NUM_CORES > 1
+    multicore_launch_core1(despachante_core1);
+#endif
+
+    despachante(0);
+}
@@ -1,7 +1,10 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "scheduler_config.h"
+#include "corrotina.h"
 
 /**
  * Tipo que representa uma funcao de tarefa
@@ -9,20 +12,243 @@
 typedef void (*funcao_tarefa_t)(void);
 
 /**
- * Inicializa o escalonador
+ * Identificador de uma tarefa adicionada ao escalonador.
+ *
+ * Combina a posicao na arena com um contador de geracao, de modo que um
+ * handle antigo nao remova por engano a tarefa que reutilizou a posicao.
+ */
+typedef uint32_t tarefa_handle_t;
+
+/**
+ * Valor devolvido quando a tarefa nao pode ser adicionada
+ */
+#define TAREFA_HANDLE_INVALIDO ((tarefa_handle_t) 0)
+
+/**
+ * Core em que a tarefa deve executar.
+ *
+ * Tarefas sem afinidade ficam numa fila compartilhada e sao executadas
+ * pelo primeiro core livre; fixar tarefas pesadas num core e as sensiveis
+ * a latencia no outro evita que umas atrasem as outras.
+ */
+typedef enum {
+    SCHEDULER_CORE_QUALQUER = 0,
+    SCHEDULER_CORE_0,
+    SCHEDULER_CORE_1,
+} afinidade_core_t;
+
+/**
+ * Criterio usado para escolher entre tarefas liberadas ao mesmo tempo
+ */
+typedef enum {
+    SCHEDULER_POLITICA_PRIORIDADE = 0, // prioridade fixa informada na configuracao
+    SCHEDULER_POLITICA_RM,             // rate monotonic: menor intervalo primeiro
+    SCHEDULER_POLITICA_EDF,            // earliest deadline first: prazo absoluto mais proximo
+} politica_escalonamento_t;
+
+/**
+ * O que fazer quando uma execucao termina depois do disparo seguinte
+ */
+typedef enum {
+    SCHEDULER_OVERRUN_EM_SEQUENCIA = 0, // executa os disparos atrasados em seguida
+    SCHEDULER_OVERRUN_PULAR,            // descarta os disparos perdidos
+    SCHEDULER_OVERRUN_GANCHO,           // descarta e chama o gancho da tarefa
+} politica_overrun_t;
+
+/**
+ * Gancho chamado quando uma tarefa ultrapassa o proprio periodo
+ * @param tarefa Handle da tarefa atrasada
+ * @param atraso_us Quanto a execucao passou do disparo seguinte
+ */
+typedef void (*funcao_overrun_t)(tarefa_handle_t tarefa, uint32_t atraso_us);
+
+/**
+ * Parametros de uma tarefa. Campos nao preenchidos (zero) usam o padrao.
+ */
+typedef struct {
+    funcao_tarefa_t tarefa;
+    uint32_t intervalo_ms;
+    afinidade_core_t core;
+
+    // Maior valor = mais importante (usada pela politica de prioridade e no desempate do RM)
+    uint8_t prioridade;
+
+    // Prazo relativo ao disparo; 0 usa o proprio intervalo
+    uint32_t prazo_ms;
+
+    politica_overrun_t overrun;
+    funcao_overrun_t gancho_overrun;
+
+    // Executa a partir de uma IRQ de software no core 0, interrompendo as
+    // tarefas comuns. Deve ser curta e nao pode bloquear (nada de printf;
+    // console_log e console_logf podem ser usados).
+    bool preemptiva;
+} tarefa_config_t;
+
+/**
+ * Estatisticas de execucao de uma tarefa, medidas com time_us_64().
+ *
+ * A latencia de liberacao e o atraso entre o disparo previsto e o inicio
+ * real da execucao. Um prazo e perdido quando a execucao termina depois
+ * do prazo da tarefa (por padrao, o disparo seguinte).
+ */
+typedef struct {
+    uint32_t execucoes;
+    uint32_t exec_min_us;
+    uint32_t exec_max_us;
+    uint64_t exec_total_us;
+    uint32_t jitter_max_us;
+    uint32_t prazos_perdidos;
+    uint32_t disparos_pulados;
+    uint32_t histograma_latencia[SCHEDULER_STATS_BUCKETS];
+} tarefa_stats_t;
+
+/**
+ * Tempo medio de execucao, em microssegundos
+ */
+static inline uint32_t tarefa_stats_media_us(const tarefa_stats_t *stats) {
+    return stats->execucoes ? (uint32_t) (stats->exec_total_us / stats->execucoes) : 0;
+}
+
+/**
+ * Uso de um core pelo escalonador.
+ *
+ * O tempo ocioso e o tempo dormindo em __wfe() esperando o proximo prazo;
+ * o ativo e o restante (tarefas, IRQs e o proprio despachante).
+ */
+typedef struct {
+    uint64_t ocioso_us;
+    uint64_t ativo_us;
+    uint32_t despertares;
+} scheduler_uso_core_t;
+
+/**
+ * Fracao do tempo ocioso, em milesimos (0 a 1000)
+ */
+static inline uint32_t scheduler_uso_ocioso_permil(const scheduler_uso_core_t *uso) {
+    uint64_t total_us = uso->ocioso_us + uso->ativo_us;
+    return total_us ? (uint32_t) (uso->ocioso_us * 1000u / total_us) : 0;
+}
+
+/**
+ * Inicializa o escalonador. Deve ser chamada no core 0.
  */
 void scheduler_init(void);
 
 /**
  * Adiciona uma tarefa periodica ao escalonador
+ *
+ * A tarefa e executada pelo laco de scheduler_start (fora de interrupcao),
+ * na ordem dos prazos mais proximos, em qualquer um dos cores.
+ * Nao deve ser chamada de uma IRQ.
+ * A posicao e obtida da arena estatica em O(1).
+ * @param tarefa Funcao a ser executada
+ * @param intervalo_ms Intervalo em milissegundos
+ * @return Handle da tarefa, ou TAREFA_HANDLE_INVALIDO se a arena estiver cheia
+ */
+tarefa_handle_t scheduler_add_task(funcao_tarefa_t tarefa, uint32_t intervalo_ms);
+
+/**
+ * Escolhe a politica de escalonamento. Deve ser chamada antes de scheduler_start.
+ */
+void scheduler_set_policy(politica_escalonamento_t politica);
+
+/**
+ * Monta uma configuracao de tarefa com os valores padrao
  * @param tarefa Funcao a ser executada
  * @param intervalo_ms Intervalo em milissegundos
  */
-void scheduler_add_task(funcao_tarefa_t tarefa, uint32_t intervalo_ms);
+tarefa_config_t scheduler_task_config(funcao_tarefa_t tarefa, uint32_t intervalo_ms);
+
+/**
+ * Adiciona uma tarefa periodica com parametros adicionais (ex.: afinidade)
+ *
+ * Pode ser chamada de qualquer um dos cores, mas nao de uma IRQ.
+ * @param config Parametros da tarefa
+ * @return Handle da tarefa, ou TAREFA_HANDLE_INVALIDO se a arena estiver cheia
+ */
+tarefa_handle_t scheduler_add_task_config(const tarefa_config_t *config);
+
+/**
+ * Adiciona uma corrotina ao escalonador (veja corrotina.h)
+ *
+ * A corrotina comeca a executar assim que um core estiver livre e e
+ * retomada quando a condicao de cada CO_AWAIT_* for satisfeita. Ao
+ * terminar (CO_END), sua posicao e liberada automaticamente.
+ * As esperas de GPIO usam a IRQ IO_IRQ_BANK0 do core 0 e as de DMA
+ * usam a DMA_IRQ_1, ambas com handlers compartilhados.
+ * @param corrotina Funcao da corrotina
+ * @param dados Estado da tarefa, repassado a cada retomada
+ * @param core Afinidade de core
+ * @return Handle da tarefa, ou TAREFA_HANDLE_INVALIDO se a arena estiver cheia
+ */
+tarefa_handle_t scheduler_add_coroutine(funcao_corrotina_t corrotina, void *dados,
+                                        afinidade_core_t core);
+
+/**
+ * Acorda a corrotina parada em CO_AWAIT_NOTIFY
+ *
+ * Pode ser chamada de IRQs e de qualquer core. Se a corrotina ainda nao
+ * estiver esperando, a notificacao fica pendente ate a proxima
+ * CO_AWAIT_NOTIFY, entao nenhum aviso se perde entre consumir os dados e
+ * voltar a esperar.
+ * @param handle Handle devolvido por scheduler_add_coroutine
+ * @return false se o handle for invalido ou nao for de uma corrotina
+ */
+bool scheduler_notify(tarefa_handle_t handle);
+
+/**
+ * Remove uma tarefa do escalonador e devolve sua posicao a arena
+ *
+ * Pode ser chamada de dentro da propria tarefa.
+ * @param handle Handle devolvido por scheduler_add_task
+ * @return false se o handle for invalido ou a tarefa ja tiver sido removida
+ */
+bool scheduler_remove_task(tarefa_handle_t handle);
+
+/**
+ * Copia as estatisticas de uma tarefa
+ * @param handle Handle devolvido por scheduler_add_task
+ * @param stats Destino da copia
+ * @return false se o handle for invalido
+ */
+bool scheduler_get_stats(tarefa_handle_t handle, tarefa_stats_t *stats);
+
+/**
+ * Consulta quanto tempo o core passou ocioso e ativo desde o inicio
+ * (ou desde o ultimo scheduler_reset_stats)
+ * @param core Numero do core (0 ou 1)
+ * @param uso Destino da consulta
+ * @return false se o core nao for usado pelo escalonador
+ */
+bool scheduler_get_core_usage(unsigned int core, scheduler_uso_core_t *uso);
+
+/**
+ * Zera as estatisticas de todas as tarefas e o uso dos cores
+ */
+void scheduler_reset_stats(void);
+
+/**
+ * Escreve no console o uso dos cores e as estatisticas das tarefas ativas
+ */
+void scheduler_dump_stats(void);
+
+/**
+ * Agenda a escrita periodica das estatisticas no console
+ * @param periodo_ms Periodo em milissegundos; 0 desativa a escrita periodica
+ * @return Handle da tarefa interna de escrita, ou TAREFA_HANDLE_INVALIDO
+ */
+tarefa_handle_t scheduler_set_stats_dump(uint32_t periodo_ms);
 
 /**
  * Inicia o escalonador
+ *
+ * Lanca o despachante no core 1 (se SCHEDULER_NUM_CORES for 2) e executa
+ * o do core 0. Entre um prazo e outro os cores dormem em __wfe() (sem tick
+ * periodico); um unico alarme de hardware os acorda no prazo mais proximo
+ * e as tarefas vencidas sao executadas em contexto de thread.
+ * Esta funcao nao retorna.
  */
 void scheduler_start(void);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,48 @@
+#ifndef SCHEDULER_CONFIG_H
+#define SCHEDULER_CONFIG_H
+
+/**
+ * Configuracoes de compilacao do escalonador.
+ *
+ * Todos os valores podem ser sobrescritos com -D ou pelo cache do CMake
+ * (ex.: cmake -DSCHEDULER_MAX_TASKS=256 ..).
+ */
+
+/**
+ * Numero de posicoes da arena estatica de tarefas
+ */
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 32
+#endif
+
+#if SCHEDULER_MAX_TASKS < 1 || SCHEDULER_MAX_TASKS > 65534
+#error "SCHEDULER_MAX_TASKS deve estar entre 1 e 65534"
+#endif
+
+/**
+ * Numero de cores que executam o despachante (1 ou 2). Com 1, o core 1
+ * fica livre para a aplicacao e tarefas com afinidade pelo core 1 rodam
+ * no core 0.
+ */
+#ifndef SCHEDULER_NUM_CORES
+#define SCHEDULER_NUM_CORES 2
+#endif
+
+#if SCHEDULER_NUM_CORES < 1 || SCHEDULER_NUM_CORES > 2
+#error "SCHEDULER_NUM_CORES deve ser 1 ou 2"
+#endif
+
+/**
+ * Numero de faixas do histograma de latencia de liberacao.
+ * A faixa i conta atrasos de 2^(i-1) a 2^i - 1 us (a faixa 0 conta atraso
+ * zero) e a ultima acumula todos os atrasos maiores.
+ */
+#ifndef SCHEDULER_STATS_BUCKETS
+#define SCHEDULER_STATS_BUCKETS 16
+#endif
+
+#if SCHEDULER_STATS_BUCKETS < 2 || SCHEDULER_STATS_BUCKETS > 33
+#error "SCHEDULER_STATS_BUCKETS deve estar entre 2 e 33"
+#endif
+
+#endif
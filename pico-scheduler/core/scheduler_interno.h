@@ -0,0 +1,51 @@
+#ifndef SCHEDULER_INTERNO_H
+#define SCHEDULER_INTERNO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "corrotina.h"
+
+/**
+ * Funcoes compartilhadas entre os modulos do escalonador.
+ * Nao fazem parte da API publica.
+ */
+
+/**
+ * Adquire/libera a trava do escalonador (spinlock + IRQs desabilitadas)
+ */
+uint32_t scheduler_travar(void);
+void scheduler_destravar(uint32_t salvo);
+
+/**
+ * Torna a corrotina pronta para executar imediatamente. Chamada com a trava,
+ * normalmente de uma IRQ que satisfez a espera.
+ */
+void scheduler_acordar(uint16_t indice);
+
+/**
+ * Instala os handlers de GPIO e DMA usados pelas esperas das corrotinas.
+ * Deve ser chamada no core 0.
+ */
+void corrotina_init(void);
+
+/**
+ * Resultado do registro de uma espera
+ */
+typedef enum {
+    CORROTINA_ESPERA_REGISTRADA = 0, // a IRQ da condicao acorda a corrotina
+    CORROTINA_ESPERA_SATISFEITA,     // condicao ja satisfeita: retoma agora
+    CORROTINA_ESPERA_RECUSADA,       // recurso invalido ou ja esperado por outra
+} corrotina_registro_t;
+
+/**
+ * Registra a espera de GPIO ou DMA pedida pela corrotina. Chamada com a trava.
+ * Cada pino e cada canal aceitam uma corrotina por vez.
+ */
+corrotina_registro_t corrotina_registrar_espera(uint16_t indice, const corrotina_t *co);
+
+/**
+ * Desfaz o registro de uma espera de GPIO ou DMA. Chamada com a trava.
+ */
+void corrotina_cancelar_espera(const corrotina_t *co);
+
+#endif
@@ -0,0 +1,227 @@
+#include "cadeia_dma.h"
+#include "hardware/irq.h"
+
+/**
+ * Cadeias registradas no handler de DMA_IRQ_0, pelo canal de dados
+ */
+static cadeia_dma_t *instancias[NUM_DMA_CHANNELS];
+static bool handler_instalado = false;
+
+/**
+ * Dispara o canal de controle com a lista ativa. Chamada com a trava.
+ */
+static void iniciar_lista(cadeia_dma_t *cadeia) {
+    cadeia->rodando = true;
+    dma_channel_set_read_addr(cadeia->canal_controle, cadeia->listas[cadeia->ativa], true);
+}
+
+/**
+ * Troca o bloco de recarga da lista por um gatilho nulo: o hardware para ao
+ * chegar nele. Chamada com a trava.
+ */
+static void encerrar_laco(cadeia_dma_t *cadeia, uint32_t indice) {
+    if (cadeia->info[indice].laco) {
+        cadeia->info[indice].laco = false;
+
+        // O bloco de recarga tem IRQ_QUIET: com tamanho 0 vira o gatilho
+        // nulo, que sinaliza o fim da lista
+        cadeia->listas[indice][cadeia->info[indice].ultimo].tamanho = 0;
+    }
+}
+
+/**
+ * Fim de uma lista (gatilho nulo): passa para a lista pendente ou para
+ */
+static void concluir_lista(cadeia_dma_t *cadeia) {
+    uint32_t salvo = spin_lock_blocking(cadeia->trava);
+    uint32_t terminada = cadeia->ativa;
+    cadeia_dma_callback_t concluida = cadeia->info[terminada].concluida;
+    void *contexto = cadeia->info[terminada].contexto;
+
+    cadeia->rodando = false;
+    if (cadeia->pendente) {
+        cadeia->pendente = false;
+        cadeia->ativa ^= 1u;
+        iniciar_lista(cadeia);
+    }
+    spin_unlock(cadeia->trava, salvo);
+
+    if (concluida) {
+        concluida(contexto);
+    }
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_0. Com irq_quiet, o canal de dados so
+ * sinaliza quando recebe o gatilho nulo do fim da lista.
+ */
+static void irq_cadeia_dma(void) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        cadeia_dma_t *cadeia = instancias[i];
+        if (cadeia && dma_channel_get_irq0_status(i)) {
+            dma_channel_acknowledge_irq0(i);
+            concluir_lista(cadeia);
+        }
+    }
+}
+
+void cadeia_dma_init(cadeia_dma_t *cadeia, volatile void *destino, uint dreq,
+                     enum dma_channel_transfer_size largura) {
+    cadeia->largura = largura;
+    cadeia->destino = destino;
+    cadeia->ativa = 0;
+    cadeia->rodando = false;
+    cadeia->pendente = false;
+    cadeia->trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+    cadeia->canal_controle = (uint) dma_claim_unused_channel(true);
+    cadeia->canal_dados = (uint) dma_claim_unused_channel(true);
+
+    // Controle: escreve {ctrl, origem, destino, tamanho} no alias 1 do canal
+    // de dados; o anel de 16 bytes repete o destino a cada bloco
+    dma_channel_config c = dma_channel_get_default_config(cadeia->canal_controle);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 4);
+    dma_channel_configure(cadeia->canal_controle, &c,
+                          &dma_hw->ch[cadeia->canal_dados].al1_ctrl,
+                          cadeia->listas[0], 4, false);
+
+    // Dados: do buffer para o periferico no ritmo do DREQ, encadeando no controle
+    c = dma_channel_get_default_config(cadeia->canal_dados);
+    channel_config_set_transfer_data_size(&c, largura);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, dreq);
+    channel_config_set_chain_to(&c, cadeia->canal_controle);
+    channel_config_set_irq_quiet(&c, true);
+    cadeia->ctrl_dados = channel_config_get_ctrl_value(&c);
+    dma_channel_configure(cadeia->canal_dados, &c, destino, NULL, 0, false);
+
+    // Recarga do laco: uma palavra (o endereco da lista) para o
+    // READ_ADDR_TRIG do controle, sem DREQ; encadear no proprio canal
+    // desativa o encadeamento
+    c = dma_channel_get_default_config(cadeia->canal_dados);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, cadeia->canal_dados);
+    channel_config_set_irq_quiet(&c, true);
+    cadeia->ctrl_recarga = channel_config_get_ctrl_value(&c);
+
+    if (!handler_instalado) {
+        irq_add_shared_handler(DMA_IRQ_0, irq_cadeia_dma, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        handler_instalado = true;
+    }
+    instancias[cadeia->canal_dados] = cadeia;
+    dma_channel_set_irq0_enabled(cadeia->canal_dados, true);
+}
+
+/**
+ * Monta a lista livre a partir dos iovecs e a inicia, ou a deixa pendente
+ */
+static bool enviar(cadeia_dma_t *cadeia, const cadeia_dma_iovec_t *iov, uint32_t quantidade,
+                   bool laco, cadeia_dma_callback_t concluida, void *contexto) {
+    if (quantidade > CADEIA_DMA_MAX_BLOCOS) {
+        return false;
+    }
+
+    // Cada iovec vira um numero inteiro de transferencias
+    for (uint32_t i = 0; i < quantidade; i++) {
+        if (iov[i].tamanho & ((1u << cadeia->largura) - 1u)) {
+            return false;
+        }
+    }
+
+    uint32_t salvo = spin_lock_blocking(cadeia->trava);
+    if (cadeia->pendente) {
+        spin_unlock(cadeia->trava, salvo);
+        return false;
+    }
+
+    uint32_t indice = cadeia->rodando ? cadeia->ativa ^ 1u : cadeia->ativa;
+    cadeia_dma_bloco_t *lista = cadeia->listas[indice];
+    uint32_t n = 0;
+
+    // Um bloco de tamanho 0 seria confundido com o fim da lista
+    for (uint32_t i = 0; i < quantidade; i++) {
+        uint32_t transferencias = iov[i].tamanho >> cadeia->largura;
+        if (transferencias > 0) {
+            lista[n] = (cadeia_dma_bloco_t) {
+                .ctrl = cadeia->ctrl_dados,
+                .origem = iov[i].dados,
+                .destino = cadeia->destino,
+                .tamanho = transferencias,
+            };
+            n++;
+        }
+    }
+
+    bool vazia = n == 0;
+    cadeia->info[indice].laco = laco && !vazia;
+    cadeia->info[indice].ultimo = n;
+    cadeia->info[indice].inicio = lista;
+    cadeia->info[indice].concluida = concluida;
+    cadeia->info[indice].contexto = contexto;
+
+    if (cadeia->info[indice].laco) {
+        // Copia o endereco da lista para o canal de controle, que recomeca
+        lista[n] = (cadeia_dma_bloco_t) {
+            .ctrl = cadeia->ctrl_recarga,
+            .origem = &cadeia->info[indice].inicio,
+            .destino = &dma_hw->ch[cadeia->canal_controle].al3_read_addr_trig,
+            .tamanho = 1,
+        };
+    } else {
+        // Gatilho nulo: com IRQ_QUIET, sinaliza o fim da lista
+        lista[n] = (cadeia_dma_bloco_t) {
+            .ctrl = cadeia->ctrl_dados,
+            .origem = NULL,
+            .destino = cadeia->destino,
+            .tamanho = 0,
+        };
+    }
+
+    if (!vazia) {
+        if (cadeia->rodando) {
+            // Um laco em andamento so termina se o bloco de recarga sair
+            cadeia->pendente = true;
+            encerrar_laco(cadeia, cadeia->ativa);
+        } else {
+            iniciar_lista(cadeia);
+        }
+    }
+    spin_unlock(cadeia->trava, salvo);
+
+    // Nada a enviar: conclui na hora
+    if (vazia && concluida) {
+        concluida(contexto);
+    }
+    return true;
+}
+
+bool cadeia_dma_writev(cadeia_dma_t *cadeia, const cadeia_dma_iovec_t *iov, uint32_t quantidade,
+                       cadeia_dma_callback_t concluida, void *contexto) {
+    return enviar(cadeia, iov, quantidade, false, concluida, contexto);
+}
+
+bool cadeia_dma_laco(cadeia_dma_t *cadeia, const cadeia_dma_iovec_t *iov, uint32_t quantidade,
+                     cadeia_dma_callback_t concluida, void *contexto) {
+    return enviar(cadeia, iov, quantidade, true, concluida, contexto);
+}
+
+void cadeia_dma_parar_laco(cadeia_dma_t *cadeia) {
+    uint32_t salvo = spin_lock_blocking(cadeia->trava);
+    if (cadeia->rodando) {
+        encerrar_laco(cadeia, cadeia->ativa);
+    }
+    spin_unlock(cadeia->trava, salvo);
+}
+
+bool cadeia_dma_ocupada(cadeia_dma_t *cadeia) {
+    uint32_t salvo = spin_lock_blocking(cadeia->trava);
+    bool ocupada = cadeia->rodando || cadeia->pendente;
+    spin_unlock(cadeia->trava, salvo);
+    return ocupada;
+}
@@ -0,0 +1,134 @@
+#ifndef CADEIA_DMA_H
+#define CADEIA_DMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+
+/**
+ * Scatter/gather por DMA para um periferico, com blocos de controle
+ * montados em tempo de execucao.
+ *
+ * Uma lista de iovecs vira uma lista de blocos {ctrl, origem, destino,
+ * tamanho}; um canal de controle carrega cada bloco no alias 1 do canal de
+ * dados (como no exemplo dma/control_blocks, que usa o alias 3), que
+ * escreve no periferico no ritmo do DREQ. Os buffers sao lidos no lugar (sem copia), entao um protocolo pode
+ * enviar cabecalho, carga e CRC sem junta-los num unico buffer:
+ *
+ *   cadeia_dma_iovec_t partes[] = {
+ *       { &cabecalho, sizeof(cabecalho) },
+ *       { carga, tamanho_carga },
+ *       { &crc, sizeof(crc) },
+ *   };
+ *   cadeia_dma_writev(&cadeia, partes, count_of(partes), enviado, NULL);
+ *
+ * Ha duas listas de blocos: enquanto uma esta no DMA, a outra pode ser
+ * montada e comeca assim que a primeira termina (pela IRQ de fim de lista,
+ * DMA_IRQ_0, handler compartilhado). Uma lista termina com o gatilho nulo
+ * ou repete em laco. O laco e feito no hardware, sem IRQ: o ultimo bloco
+ * reprograma o canal de dados para copiar o endereco da lista para o
+ * READ_ADDR_TRIG do canal de controle, que recomeca do primeiro bloco.
+ */
+
+/**
+ * Maior numero de iovecs por lista
+ */
+#ifndef CADEIA_DMA_MAX_BLOCOS
+#define CADEIA_DMA_MAX_BLOCOS 8
+#endif
+
+typedef struct {
+    const void *dados;
+    uint32_t tamanho; // em bytes, multiplo da largura das transferencias
+} cadeia_dma_iovec_t;
+
+/**
+ * Chamada quando a lista termina e seus buffers podem ser reutilizados.
+ * Executa na IRQ de DMA do core que chamou cadeia_dma_init.
+ */
+typedef void (*cadeia_dma_callback_t)(void *contexto);
+
+/**
+ * Bloco de controle, na ordem dos registradores do alias 1
+ */
+typedef struct {
+    uint32_t ctrl;
+    const volatile void *origem;
+    volatile void *destino;
+    uint32_t tamanho;
+} cadeia_dma_bloco_t;
+
+/**
+ * Estado de uma cadeia. Os campos sao internos.
+ */
+typedef struct {
+    uint canal_dados;
+    uint canal_controle;
+    spin_lock_t *trava;
+    enum dma_channel_transfer_size largura;
+    volatile void *destino;
+    uint32_t ctrl_dados;  // CTRL do canal de dados nos blocos de iovec
+    uint32_t ctrl_recarga; // CTRL do bloco que reinicia o laco
+
+    // listas[ativa] esta no DMA (se rodando); listas[ativa ^ 1] espera se pendente
+    cadeia_dma_bloco_t listas[2][CADEIA_DMA_MAX_BLOCOS + 1];
+    struct {
+        bool laco;
+        uint32_t ultimo;                // bloco final (gatilho nulo ou recarga)
+        const cadeia_dma_bloco_t *inicio; // lido pelo bloco de recarga
+        cadeia_dma_callback_t concluida;
+        void *contexto;
+    } info[2];
+    uint32_t ativa;
+    bool rodando;
+    bool pendente;
+} cadeia_dma_t;
+
+/**
+ * Reserva dois canais de DMA para escrever num periferico
+ *
+ * O estado deve permanecer valido (estatico) enquanto a cadeia for usada.
+ * @param cadeia Estado a ser inicializado
+ * @param destino Registrador de dados do periferico (ex.: &uart_get_hw(uart)->dr)
+ * @param dreq DREQ do periferico (ex.: uart_get_dreq(uart, true))
+ * @param largura Largura de cada transferencia
+ */
+void cadeia_dma_init(cadeia_dma_t *cadeia, volatile void *destino, uint dreq,
+                     enum dma_channel_transfer_size largura);
+
+/**
+ * Envia os iovecs em sequencia, sem copia-los
+ *
+ * Se a cadeia estiver ocupada, a lista comeca quando a atual terminar (uma
+ * lista em laco e encerrada no fim de uma volta). iovecs vazios sao
+ * ignorados. Os buffers nao podem ser alterados ate o callback.
+ * @param concluida Callback de conclusao (pode ser NULL)
+ * @return false se ja houver uma lista esperando, `quantidade` for maior
+ *         que CADEIA_DMA_MAX_BLOCOS ou algum tamanho nao for multiplo da
+ *         largura das transferencias
+ */
+bool cadeia_dma_writev(cadeia_dma_t *cadeia, const cadeia_dma_iovec_t *iov, uint32_t quantidade,
+                       cadeia_dma_callback_t concluida, void *contexto);
+
+/**
+ * Como cadeia_dma_writev, mas a lista se repete ate ser substituida por
+ * outra ou encerrada com cadeia_dma_parar_laco. O callback e chamado quando
+ * ela deixa de ser usada.
+ */
+bool cadeia_dma_laco(cadeia_dma_t *cadeia, const cadeia_dma_iovec_t *iov, uint32_t quantidade,
+                     cadeia_dma_callback_t concluida, void *contexto);
+
+/**
+ * Encerra o laco atual no fim da volta em andamento (ou da seguinte, se o
+ * hardware ja tiver lido o bloco de recarga desta)
+ */
+void cadeia_dma_parar_laco(cadeia_dma_t *cadeia);
+
+/**
+ * Indica se ha uma lista em andamento ou esperando
+ */
+bool cadeia_dma_ocupada(cadeia_dma_t *cadeia);
+
+#endif
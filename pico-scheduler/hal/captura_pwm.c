@@ -0,0 +1,150 @@
+#include "captura_pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+
+/**
+ * Estado de uma fatia em captura. `sequencia` e impar enquanto o
+ * temporizador escreve `leitura`.
+ */
+typedef struct {
+    volatile uint32_t sequencia;
+    captura_pwm_leitura_t leitura;
+    bool contando;
+    bool contando_bordas;
+    bool ciclo_valido;
+    bool frequencia_valida;
+} fatia_captura_t;
+
+static fatia_captura_t fatias[NUM_PWM_SLICES];
+static volatile uint32_t mascara_fatias = 0;
+
+static repeating_timer_t temporizador;
+static uint32_t janela_us;
+static uint32_t divisor_ciclo;
+static uint32_t inicio_janela_us;
+
+/**
+ * Configura a fatia para a proxima janela, com o contador zerado
+ */
+static void configurar(uint fatia, bool contar_bordas) {
+    pwm_config cfg = pwm_get_default_config();
+    pwm_config_set_clkdiv_mode(&cfg, contar_bordas ? PWM_DIV_B_RISING : PWM_DIV_B_HIGH);
+    pwm_config_set_clkdiv_int(&cfg, contar_bordas ? 1 : divisor_ciclo);
+    pwm_init(fatia, &cfg, false);
+}
+
+/**
+ * Publica a contagem da janela que terminou
+ */
+static void publicar(fatia_captura_t *f, uint32_t contagem, uint32_t duracao_us, uint32_t agora_us) {
+    f->sequencia++;
+    __dmb();
+
+    if (f->contando_bordas) {
+        f->leitura.frequencia_mhz = (uint32_t) ((uint64_t) contagem * 1000000000u / duracao_us);
+        f->frequencia_valida = true;
+    } else {
+        uint64_t ciclos_janela = (uint64_t) clock_get_hz(clk_sys) * duracao_us / 1000000u;
+        uint64_t ciclos_alto = (uint64_t) contagem * divisor_ciclo;
+        uint64_t ppm = ciclos_janela ? ciclos_alto * 1000000u / ciclos_janela : 0;
+        f->leitura.ciclo_ppm = (uint32_t) (ppm > 1000000u ? 1000000u : ppm);
+        f->ciclo_valido = true;
+    }
+    f->leitura.medicoes++;
+    f->leitura.instante_us = agora_us;
+
+    __dmb();
+    f->sequencia++;
+}
+
+/**
+ * Fecha a janela de todas as fatias ao mesmo tempo, publica as contagens,
+ * troca o modo de cada fatia e abre a janela seguinte
+ */
+static bool fechar_janela(repeating_timer_t *t) {
+    (void) t;
+    uint32_t mascara = mascara_fatias;
+
+    hw_clear_bits(&pwm_hw->en, mascara);
+    uint32_t agora_us = time_us_32();
+    uint32_t duracao_us = agora_us - inicio_janela_us;
+
+    for (uint fatia = 0; fatia < NUM_PWM_SLICES; fatia++) {
+        if (mascara & (1u << fatia)) {
+            fatia_captura_t *f = &fatias[fatia];
+
+            // Fatia recem-adicionada: ainda nao contou, comeca nesta janela
+            if (!f->contando) {
+                f->contando = true;
+                continue;
+            }
+
+            if (duracao_us > 0) {
+                publicar(f, pwm_get_counter(fatia), duracao_us, agora_us);
+            }
+            f->contando_bordas = !f->contando_bordas;
+            configurar(fatia, f->contando_bordas);
+        }
+    }
+
+    inicio_janela_us = time_us_32();
+    hw_set_bits(&pwm_hw->en, mascara);
+    return true;
+}
+
+bool captura_pwm_init(uint32_t janela) {
+    // Ciclos do sistema numa janela divididos para caber em 16 bits
+    uint64_t ciclos = (uint64_t) clock_get_hz(clk_sys) * janela / 1000000u;
+    uint64_t divisor = (ciclos + 0xfffeu) / 0xffffu;
+
+    if (janela == 0 || divisor > 255) {
+        return false;
+    }
+
+    janela_us = janela;
+    divisor_ciclo = divisor ? (uint32_t) divisor : 1;
+    inicio_janela_us = time_us_32();
+    return add_repeating_timer_us(-(int64_t) janela_us, fechar_janela, NULL, &temporizador);
+}
+
+bool captura_pwm_adicionar(uint32_t gpio) {
+    uint fatia = pwm_gpio_to_slice_num(gpio);
+    if (pwm_gpio_to_channel(gpio) != PWM_CHAN_B || (mascara_fatias & (1u << fatia))) {
+        return false;
+    }
+
+    fatias[fatia] = (fatia_captura_t) { 0 };
+    configurar(fatia, false);
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+
+    // A fatia entra na proxima janela completa: o temporizador a habilita
+    uint32_t salvo = save_and_disable_interrupts();
+    mascara_fatias |= 1u << fatia;
+    restore_interrupts(salvo);
+    return true;
+}
+
+bool captura_pwm_ler(uint32_t gpio, captura_pwm_leitura_t *leitura) {
+    uint fatia = pwm_gpio_to_slice_num(gpio);
+    if (!(mascara_fatias & (1u << fatia))) {
+        return false;
+    }
+
+    const fatia_captura_t *f = &fatias[fatia];
+    uint32_t sequencia;
+    bool completa;
+
+    // Repete se o temporizador publicou durante a copia
+    do {
+        sequencia = f->sequencia;
+        __dmb();
+        *leitura = f->leitura;
+        completa = f->ciclo_valido && f->frequencia_valida;
+        __dmb();
+    } while ((sequencia & 1u) || sequencia != f->sequencia);
+
+    return completa;
+}
@@ -0,0 +1,60 @@
+#ifndef CAPTURA_PWM_H
+#define CAPTURA_PWM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Medicao continua de ciclo de trabalho e frequencia em varias entradas,
+ * usando as fatias de PWM como contadores com janela (gated counting).
+ *
+ * Cada pino precisa ser o canal B de uma fatia (no maximo uma entrada por
+ * fatia, 8 no total). Um unico temporizador repetitivo fecha a janela de
+ * todas as fatias ao mesmo tempo e alterna o modo de cada uma:
+ * - PWM_DIV_B_HIGH conta os ciclos do sistema com a entrada em nivel alto
+ *   (ciclo de trabalho);
+ * - PWM_DIV_B_RISING conta as bordas de subida (frequencia).
+ * Cada grandeza e atualizada a cada duas janelas, sem bloquear ninguem.
+ *
+ * Os resultados ficam em instantaneos protegidos por um contador de
+ * sequencia (seqlock): captura_pwm_ler nunca espera o temporizador e pode
+ * ser chamada de qualquer core.
+ *
+ * Limites: a frequencia tem resolucao de 1 / janela (ex.: 10 Hz com 100 ms)
+ * e o contador de 16 bits limita a janela (ate ~130 ms a 125 MHz) e a
+ * frequencia maxima (65535 bordas por janela).
+ */
+
+/**
+ * Ultima medicao de uma entrada
+ */
+typedef struct {
+    uint32_t ciclo_ppm;      // fracao do tempo em nivel alto, em partes por milhao
+    uint32_t frequencia_mhz; // bordas de subida por segundo, em milesimos de Hz
+    uint32_t medicoes;       // numero de janelas ja publicadas
+    uint32_t instante_us;    // fim da ultima janela (time_us_32)
+} captura_pwm_leitura_t;
+
+/**
+ * Inicia o temporizador compartilhado no core atual
+ * @param janela_us Duracao de cada janela de contagem
+ * @return false se a janela nao couber no contador de 16 bits
+ */
+bool captura_pwm_init(uint32_t janela_us);
+
+/**
+ * Passa a medir um pino a partir da proxima janela. Chame sempre do
+ * mesmo core.
+ * @param gpio Pino do canal B de uma fatia de PWM
+ * @return false se o pino nao for de canal B ou a fatia ja estiver em uso
+ */
+bool captura_pwm_adicionar(uint32_t gpio);
+
+/**
+ * Copia a ultima medicao de um pino, sem bloquear
+ * @return false se o pino nao estiver sendo medido ou ainda nao houver
+ *         medicao completa
+ */
+bool captura_pwm_ler(uint32_t gpio, captura_pwm_leitura_t *leitura);
+
+#endif
@@ -1,11 +1,236 @@
 #include "console.h"
 #include "pico/stdlib.h"
+#include "hardware/sync.h"
 #include <stdio.h>
+#include <string.h>
+
+#if CONSOLE_UART_DMA && !LIB_PICO_STDIO_UART
+#undef CONSOLE_UART_DMA
+#define CONSOLE_UART_DMA 0
+#endif
+
+#if CONSOLE_UART_DMA
+#include "uart_tx_dma.h"
+#endif
+
+#if (CONSOLE_FILA_TAMANHO & (CONSOLE_FILA_TAMANHO - 1)) != 0
+#error "CONSOLE_FILA_TAMANHO deve ser potencia de 2"
+#endif
+
+/**
+ * Uma mensagem pendente: texto copiado (formato == NULL) ou formato e
+ * argumentos brutos, formatados so no envio
+ */
+typedef struct {
+    const char *formato;
+    uint32_t num_args;
+    union {
+        uintptr_t args[CONSOLE_MAX_ARGS];
+        char texto[CONSOLE_TEXTO_MAX];
+    };
+} mensagem_console_t;
+
+static mensagem_console_t fila[CONSOLE_FILA_TAMANHO];
+
+/**
+ * Contadores livres (nunca reiniciam); a posicao e contador % tamanho
+ */
+static uint32_t inicio = 0;
+static uint32_t fim = 0;
+
+static volatile uint32_t descartadas = 0;
+static uint32_t descartadas_avisadas = 0;
+
+/**
+ * Spinlock de hardware: o M0+ nao tem instrucoes atomicas de comparacao,
+ * entao a reserva de posicao na fila usa o spinlock (poucos ciclos, com
+ * as IRQs do core desabilitadas)
+ */
+static spin_lock_t *trava = NULL;
+
+/**
+ * Formata uma linha em `destino`, truncando se preciso, sempre terminada
+ * em '\n'. Todos os CONSOLE_MAX_ARGS argumentos sao repassados; os que o
+ * formato nao usa sao ignorados.
+ * @return Tamanho da linha, sem o terminador
+ */
+static size_t formatar(char *destino, size_t espaco, const char *formato, const uintptr_t *a) {
+    int n = snprintf(destino, espaco, "[CONSOLE] ");
+    n += snprintf(destino + n, espaco - (size_t) n, formato,
+                  a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+
+    size_t tamanho = MIN((size_t) n, espaco - 2);
+    destino[tamanho++] = '\n';
+    destino[tamanho] = '\0';
+    return tamanho;
+}
+
+static void escrever_formatada(const char *formato, const uintptr_t *a) {
+    char linha[CONSOLE_LINHA_MAX];
+    formatar(linha, sizeof(linha), formato, a);
+    fputs(linha, stdout);
+}
+
+#if CONSOLE_UART_DMA
+/**
+ * Dois buffers de envio: um e preenchido enquanto o outro esta no DMA
+ */
+static char buffers_tx[2][CONSOLE_BUFFER_TX];
+static volatile bool buffer_ocupado[2];
+static uint32_t buffer_atual = 0;
+static uart_tx_dma_t saida;
+
+static void buffer_enviado(void *contexto) {
+    buffer_ocupado[(uintptr_t) contexto] = false;
+}
+#endif
 
 void console_init(void) {
     stdio_init_all();
+    trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+
+#if CONSOLE_UART_DMA
+    uart_tx_dma_init(&saida, uart_default);
+#endif
+}
+
+/**
+ * Reserva a proxima posicao livre. Chamada com a trava.
+ * @return NULL se a fila estiver cheia
+ */
+static mensagem_console_t *reservar(void) {
+    if (fim - inicio >= CONSOLE_FILA_TAMANHO) {
+        descartadas++;
+        return NULL;
+    }
+    return &fila[fim++ % CONSOLE_FILA_TAMANHO];
 }
 
 void console_log(const char *mensagem) {
-    printf("[CONSOLE] %s\n", mensagem);
-}
\ No newline at end of file
+    // Antes de console_init nao ha fila: escreve direto
+    if (!trava) {
+        const uintptr_t args[CONSOLE_MAX_ARGS] = { (uintptr_t) mensagem };
+        escrever_formatada("%s", args);
+        return;
+    }
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    mensagem_console_t *nova = reservar();
+    if (nova) {
+        nova->formato = NULL;
+        nova->num_args = 0;
+        strncpy(nova->texto, mensagem, CONSOLE_TEXTO_MAX - 1);
+        nova->texto[CONSOLE_TEXTO_MAX - 1] = '\0';
+    }
+    spin_unlock(trava, salvo);
+}
+
+void console_logf_n(const char *formato, uint32_t num_args, const uintptr_t *args) {
+    if (num_args > CONSOLE_MAX_ARGS) {
+        num_args = CONSOLE_MAX_ARGS;
+    }
+
+    if (!trava) {
+        uintptr_t a[CONSOLE_MAX_ARGS] = { 0 };
+        for (uint32_t i = 0; i < num_args; i++) {
+            a[i] = args[i];
+        }
+        escrever_formatada(formato, a);
+        return;
+    }
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    mensagem_console_t *nova = reservar();
+    if (nova) {
+        nova->formato = formato;
+        nova->num_args = num_args;
+        for (uint32_t i = 0; i < num_args; i++) {
+            nova->args[i] = args[i];
+        }
+    }
+    spin_unlock(trava, salvo);
+}
+
+/**
+ * Retira a proxima mensagem da fila e a formata em `destino`. Antes dela,
+ * avisa quantas mensagens foram descartadas desde o ultimo aviso.
+ * @return Tamanho da linha, ou 0 se a fila estiver vazia
+ */
+static size_t proxima_linha(char *destino, size_t espaco) {
+    mensagem_console_t mensagem;
+
+    // Copia a mensagem e libera a posicao antes de formatar, para nao
+    // segurar a trava durante a formatacao
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint32_t total_descartadas = descartadas;
+    bool vazia = inicio == fim;
+    if (!vazia && total_descartadas == descartadas_avisadas) {
+        mensagem = fila[inicio % CONSOLE_FILA_TAMANHO];
+        inicio++;
+    }
+    spin_unlock(trava, salvo);
+
+    if (total_descartadas != descartadas_avisadas) {
+        const uintptr_t args[CONSOLE_MAX_ARGS] = { total_descartadas - descartadas_avisadas };
+        descartadas_avisadas = total_descartadas;
+        return formatar(destino, espaco, "%lu mensagens descartadas (fila cheia)", args);
+    }
+
+    if (vazia) {
+        return 0;
+    }
+
+    if (!mensagem.formato) {
+        const uintptr_t args[CONSOLE_MAX_ARGS] = { (uintptr_t) mensagem.texto };
+        return formatar(destino, espaco, "%s", args);
+    }
+
+    for (uint32_t i = mensagem.num_args; i < CONSOLE_MAX_ARGS; i++) {
+        mensagem.args[i] = 0;
+    }
+    return formatar(destino, espaco, mensagem.formato, mensagem.args);
+}
+
+void console_flush(void) {
+    if (!trava) {
+        return;
+    }
+
+#if CONSOLE_UART_DMA
+    // Enche o buffer livre com varias linhas e o entrega ao DMA de uma vez;
+    // se os dois estiverem em envio, o restante fica para a proxima chamada
+    while (!buffer_ocupado[buffer_atual]) {
+        char *buffer = buffers_tx[buffer_atual];
+        size_t usado = 0;
+
+        while (CONSOLE_BUFFER_TX - usado >= CONSOLE_LINHA_MAX) {
+            size_t tamanho = proxima_linha(buffer + usado, CONSOLE_LINHA_MAX);
+            if (tamanho == 0) {
+                break;
+            }
+            usado += tamanho;
+        }
+
+        if (usado == 0) {
+            return;
+        }
+
+        buffer_ocupado[buffer_atual] = true;
+        if (!uart_tx_dma_enviar(&saida, buffer, usado, buffer_enviado,
+                                (void *) (uintptr_t) buffer_atual)) {
+            buffer_ocupado[buffer_atual] = false;
+            return;
+        }
+        buffer_atual ^= 1u;
+    }
+#else
+    char linha[CONSOLE_LINHA_MAX];
+    while (proxima_linha(linha, sizeof(linha)) > 0) {
+        fputs(linha, stdout);
+    }
+#endif
+}
+
+uint32_t console_get_overflows(void) {
+    return descartadas;
+}
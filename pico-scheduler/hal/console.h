@@ -1,15 +1,121 @@
 #ifndef CONSOLE_H
 #define CONSOLE_H
 
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Console com buffer: quem escreve apenas grava a mensagem numa fila
+ * circular (sem esperar a UART/USB) e console_flush() formata e envia
+ * as mensagens depois, fora do caminho critico. Pode ser usado de
+ * qualquer core e de dentro de IRQs.
+ */
+
+/**
+ * Numero de mensagens na fila (potencia de 2)
+ */
+#ifndef CONSOLE_FILA_TAMANHO
+#define CONSOLE_FILA_TAMANHO 32
+#endif
+
+/**
+ * Maior texto copiado por console_log, incluindo o terminador
+ */
+#ifndef CONSOLE_TEXTO_MAX
+#define CONSOLE_TEXTO_MAX 64
+#endif
+
+/**
+ * Maior linha formatada por console_flush, incluindo o prefixo
+ */
+#ifndef CONSOLE_LINHA_MAX
+#define CONSOLE_LINHA_MAX 96
+#endif
+
+/**
+ * Envia as linhas pela UART do stdio usando DMA (uart_tx_dma.h), em vez
+ * de printf. Sem stdio na UART, o console volta a usar o stdout.
+ */
+#ifndef CONSOLE_UART_DMA
+#define CONSOLE_UART_DMA 1
+#endif
+
+/**
+ * Tamanho de cada um dos dois buffers de envio por DMA
+ */
+#ifndef CONSOLE_BUFFER_TX
+#define CONSOLE_BUFFER_TX 512
+#endif
+
 /**
- * Inicializa o console (stdout)
+ * Maior numero de argumentos de console_logf
+ */
+#define CONSOLE_MAX_ARGS 8
+
+/**
+ * Inicializa o console (stdout). Depois dela, a saida da UART do stdio
+ * deve passar pelo console, pois o DMA escreve direto no FIFO.
  */
 void console_init(void);
 
 /**
  * Exibe uma mensagem no console
+ *
+ * O texto e copiado para a fila (truncado em CONSOLE_TEXTO_MAX - 1
+ * caracteres), entao pode estar num buffer temporario.
  * @param mensagem Texto a ser exibido
  */
 void console_log(const char *mensagem);
 
-#endif
\ No newline at end of file
+/**
+ * Exibe uma mensagem formatada, adiando a formatacao para console_flush
+ *
+ * Grava apenas o ponteiro do formato e os argumentos brutos (uma palavra
+ * cada). Por isso:
+ * - o formato e os argumentos %s devem ser strings constantes;
+ * - sao aceitos ate CONSOLE_MAX_ARGS argumentos inteiros de ate 32 bits
+ *   ou ponteiros; nada de float, double ou valores de 64 bits.
+ * @param formato Formato no estilo printf
+ */
+#define console_logf(formato, ...)                                            \
+    console_logf_n((formato), CONSOLE_CONTAR_ARGS_(__VA_ARGS__),               \
+                   (const uintptr_t[]) { 0, CONSOLE_MAPEAR_(                  \
+                       CONSOLE_CONTAR_ARGS_(__VA_ARGS__), ##__VA_ARGS__) } + 1)
+
+/**
+ * Envia as mensagens pendentes na fila. Pode ser registrada como tarefa
+ * periodica do escalonador: scheduler_add_task(console_flush, 10).
+ */
+void console_flush(void);
+
+/**
+ * Quantidade de mensagens descartadas porque a fila estava cheia
+ */
+uint32_t console_get_overflows(void);
+
+/**
+ * Implementacao de console_logf; prefira a macro
+ */
+void console_logf_n(const char *formato, uint32_t num_args, const uintptr_t *args);
+
+// Conta os argumentos da macro e converte cada um numa palavra
+#define CONSOLE_CONTAR_ARGS_(...) \
+    CONSOLE_CONTAR_ARGS_N_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define CONSOLE_CONTAR_ARGS_N_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+#define CONSOLE_CONCATENAR_(a, b) CONSOLE_CONCATENAR2_(a, b)
+#define CONSOLE_CONCATENAR2_(a, b) a##b
+#define CONSOLE_MAPEAR_(n, ...) CONSOLE_CONCATENAR_(CONSOLE_MAPEAR_, n)(__VA_ARGS__)
+
+#define CONSOLE_ARG_(x) (uintptr_t) (x)
+#define CONSOLE_MAPEAR_0(...)
+#define CONSOLE_MAPEAR_1(a) CONSOLE_ARG_(a)
+#define CONSOLE_MAPEAR_2(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_1(__VA_ARGS__)
+#define CONSOLE_MAPEAR_3(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_2(__VA_ARGS__)
+#define CONSOLE_MAPEAR_4(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_3(__VA_ARGS__)
+#define CONSOLE_MAPEAR_5(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_4(__VA_ARGS__)
+#define CONSOLE_MAPEAR_6(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_5(__VA_ARGS__)
+#define CONSOLE_MAPEAR_7(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_6(__VA_ARGS__)
+#define CONSOLE_MAPEAR_8(a, ...) CONSOLE_ARG_(a), CONSOLE_MAPEAR_7(__VA_ARGS__)
+
+#endif
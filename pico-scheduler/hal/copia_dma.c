@@ -0,0 +1,216 @@
+#include "copia_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+
+/**
+ * Um pedido: o corpo [cabeca, cabeca + transferencias << largura) vai pelo
+ * DMA e o restante e feito pela CPU na conclusao
+ */
+typedef struct {
+    uint8_t *destino;
+    const uint8_t *origem;
+    uint32_t tamanho;
+    uint32_t cabeca;
+    uint32_t transferencias;
+    enum dma_channel_transfer_size largura;
+    bool preencher;
+    uint8_t valor;
+    copia_dma_callback_t callback;
+    void *contexto;
+} pedido_copia_t;
+
+typedef struct {
+    uint canal;
+    bool ocupado;
+    uint32_t padrao; // palavra lida pelo memset
+    pedido_copia_t pedido;
+} canal_copia_t;
+
+static canal_copia_t canais[COPIA_DMA_CANAIS];
+static spin_lock_t *trava;
+
+static pedido_copia_t fila[COPIA_DMA_FILA];
+static uint32_t inicio = 0;
+static uint32_t tamanho_fila = 0;
+
+/**
+ * Escolhe a largura e a cabeca do corpo. O DMA so usa 32 (ou 16) bits se
+ * destino e origem estiverem igualmente desalinhados; o memset so depende
+ * do destino.
+ */
+static void dividir(pedido_copia_t *p) {
+    uintptr_t destino = (uintptr_t) p->destino;
+    uintptr_t diferenca = p->preencher ? 0 : destino ^ (uintptr_t) p->origem;
+
+    if ((diferenca & 3u) == 0) {
+        p->largura = DMA_SIZE_32;
+        p->cabeca = (uint32_t) (-destino & 3u);
+    } else if ((diferenca & 1u) == 0) {
+        p->largura = DMA_SIZE_16;
+        p->cabeca = (uint32_t) (destino & 1u);
+    } else {
+        p->largura = DMA_SIZE_8;
+        p->cabeca = 0;
+    }
+
+    p->cabeca = MIN(p->cabeca, p->tamanho);
+    p->transferencias = (p->tamanho - p->cabeca) >> p->largura;
+}
+
+/**
+ * Dispara o corpo do pedido no canal. Chamada com a trava.
+ */
+static void iniciar(canal_copia_t *c, const pedido_copia_t *p) {
+    c->ocupado = true;
+    c->pedido = *p;
+    c->padrao = p->valor * 0x01010101u;
+
+    dma_channel_config cfg = dma_channel_get_default_config(c->canal);
+    channel_config_set_transfer_data_size(&cfg, p->largura);
+    channel_config_set_read_increment(&cfg, !p->preencher);
+    channel_config_set_write_increment(&cfg, true);
+
+    const void *leitura = p->preencher ? (const void *) &c->padrao : p->origem + p->cabeca;
+    dma_channel_configure(c->canal, &cfg, p->destino + p->cabeca, leitura, p->transferencias, true);
+}
+
+/**
+ * Copia a cabeca e a cauda pela CPU e chama o callback
+ */
+static void concluir(const pedido_copia_t *p) {
+    uint32_t fim_corpo = p->cabeca + (p->transferencias << p->largura);
+
+    for (uint32_t i = 0; i < p->cabeca; i++) {
+        p->destino[i] = p->preencher ? p->valor : p->origem[i];
+    }
+    for (uint32_t i = fim_corpo; i < p->tamanho; i++) {
+        p->destino[i] = p->preencher ? p->valor : p->origem[i];
+    }
+
+    if (p->callback) {
+        p->callback(p->contexto);
+    }
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_0: conclui o pedido de cada canal que
+ * terminou e passa para ele o proximo da fila
+ */
+static void irq_copia_dma(void) {
+    for (uint i = 0; i < COPIA_DMA_CANAIS; i++) {
+        canal_copia_t *c = &canais[i];
+        if (!dma_channel_get_irq0_status(c->canal)) {
+            continue;
+        }
+        dma_channel_acknowledge_irq0(c->canal);
+
+        // O canal continua ocupado (e o pedido contado em
+        // copia_dma_pendentes) ate a cabeca e a cauda estarem escritas
+        concluir(&c->pedido);
+
+        uint32_t salvo = spin_lock_blocking(trava);
+        c->ocupado = false;
+        if (tamanho_fila > 0) {
+            iniciar(c, &fila[inicio]);
+            inicio = (inicio + 1u) % COPIA_DMA_FILA;
+            tamanho_fila--;
+        }
+        spin_unlock(trava, salvo);
+    }
+}
+
+void copia_dma_init(void) {
+    trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+
+    for (uint i = 0; i < COPIA_DMA_CANAIS; i++) {
+        canais[i].canal = (uint) dma_claim_unused_channel(true);
+        canais[i].ocupado = false;
+        dma_channel_set_irq0_enabled(canais[i].canal, true);
+    }
+
+    irq_add_shared_handler(DMA_IRQ_0, irq_copia_dma, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+/**
+ * Entrega o pedido a um canal livre ou a fila
+ */
+static bool enviar(pedido_copia_t *p) {
+    dividir(p);
+
+    // Sem corpo para o DMA: a CPU faz tudo agora
+    if (p->transferencias == 0) {
+        concluir(p);
+        return true;
+    }
+
+    bool aceito = true;
+    uint32_t salvo = spin_lock_blocking(trava);
+
+    canal_copia_t *livre = NULL;
+    for (uint i = 0; i < COPIA_DMA_CANAIS && !livre; i++) {
+        if (!canais[i].ocupado) {
+            livre = &canais[i];
+        }
+    }
+
+    if (livre) {
+        iniciar(livre, p);
+    } else if (tamanho_fila < COPIA_DMA_FILA) {
+        fila[(inicio + tamanho_fila) % COPIA_DMA_FILA] = *p;
+        tamanho_fila++;
+    } else {
+        aceito = false;
+    }
+
+    spin_unlock(trava, salvo);
+    return aceito;
+}
+
+bool copia_dma_memcpy(void *destino, const void *origem, size_t tamanho,
+                      copia_dma_callback_t callback, void *contexto) {
+    pedido_copia_t p = {
+        .destino = destino,
+        .origem = origem,
+        .tamanho = (uint32_t) tamanho,
+        .preencher = false,
+        .callback = callback,
+        .contexto = contexto,
+    };
+    return enviar(&p);
+}
+
+bool copia_dma_memset(void *destino, uint8_t valor, size_t tamanho,
+                      copia_dma_callback_t callback, void *contexto) {
+    pedido_copia_t p = {
+        .destino = destino,
+        .tamanho = (uint32_t) tamanho,
+        .preencher = true,
+        .valor = valor,
+        .callback = callback,
+        .contexto = contexto,
+    };
+    return enviar(&p);
+}
+
+uint32_t copia_dma_pendentes(void) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    uint32_t pendentes = tamanho_fila;
+    for (uint i = 0; i < COPIA_DMA_CANAIS; i++) {
+        pendentes += canais[i].ocupado;
+    }
+    spin_unlock(trava, salvo);
+    return pendentes;
+}
+
+void copia_dma_futuro_concluir(void *futuro) {
+    ((copia_dma_futuro_t *) futuro)->concluido = true;
+}
+
+void copia_dma_esperar(copia_dma_futuro_t *futuro) {
+    while (!futuro->concluido) {
+        tight_loop_contents();
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef COPIA_DMA_H
+#define COPIA_DMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * memcpy e memset assincronos por DMA.
+ *
+ * Os pedidos sao distribuidos entre COPIA_DMA_CANAIS canais reservados na
+ * inicializacao; quando todos estao ocupados, esperam numa fila. O corpo de
+ * cada pedido usa a maior transferencia possivel (32 bits quando origem e
+ * destino tem o mesmo alinhamento) e os poucos bytes desalinhados do
+ * inicio e do fim sao copiados pela CPU na conclusao. O memset le sempre a
+ * mesma palavra, sem incrementar o endereco de leitura.
+ *
+ * O fim de cada pedido chega por callback na IRQ de DMA (DMA_IRQ_0,
+ * handler compartilhado) ou por um futuro:
+ *
+ *   copia_dma_futuro_t futuro;
+ *   copia_dma_futuro_iniciar(&futuro);
+ *   copia_dma_memcpy(destino, origem, tamanho, copia_dma_futuro_concluir, &futuro);
+ *   ...
+ *   copia_dma_esperar(&futuro);
+ *
+ * Para pedidos pequenos a CPU e mais rapida: bench/bench_copia_dma mostra
+ * a partir de que tamanho o DMA compensa.
+ */
+
+/**
+ * Numero de canais de DMA reservados
+ */
+#ifndef COPIA_DMA_CANAIS
+#define COPIA_DMA_CANAIS 2
+#endif
+
+/**
+ * Numero de pedidos esperando um canal livre
+ */
+#ifndef COPIA_DMA_FILA
+#define COPIA_DMA_FILA 16
+#endif
+
+/**
+ * Chamada quando o pedido termina. Executa na IRQ de DMA do core que
+ * chamou copia_dma_init, ou direto na chamada se o DMA nao for necessario.
+ */
+typedef void (*copia_dma_callback_t)(void *contexto);
+
+/**
+ * Futuro de um pedido: use copia_dma_futuro_concluir como callback
+ */
+typedef struct {
+    volatile bool concluido;
+} copia_dma_futuro_t;
+
+static inline void copia_dma_futuro_iniciar(copia_dma_futuro_t *futuro) {
+    futuro->concluido = false;
+}
+
+/**
+ * Callback que marca o futuro passado como contexto
+ */
+void copia_dma_futuro_concluir(void *futuro);
+
+/**
+ * Espera o futuro ser concluido (nao chame de uma IRQ)
+ */
+void copia_dma_esperar(copia_dma_futuro_t *futuro);
+
+/**
+ * Reserva os canais e instala o handler no core atual
+ */
+void copia_dma_init(void);
+
+/**
+ * Copia `tamanho` bytes de `origem` para `destino` (sem sobreposicao).
+ * Os buffers devem ficar intactos ate a conclusao.
+ * @param callback Chamada no fim (pode ser NULL)
+ * @return false se a fila estiver cheia; nada e copiado
+ */
+bool copia_dma_memcpy(void *destino, const void *origem, size_t tamanho,
+                      copia_dma_callback_t callback, void *contexto);
+
+/**
+ * Preenche `tamanho` bytes de `destino` com `valor`
+ * @param callback Chamada no fim (pode ser NULL)
+ * @return false se a fila estiver cheia; nada e escrito
+ */
+bool copia_dma_memset(void *destino, uint8_t valor, size_t tamanho,
+                      copia_dma_callback_t callback, void *contexto);
+
+/**
+ * Numero de pedidos em andamento ou na fila
+ */
+uint32_t copia_dma_pendentes(void);
+
+#endif
@@ -0,0 +1,112 @@
+#include "crc32.h"
+
+#if CRC32_TABELA_NA_RAM
+#define CRC32_TABELA_CONST
+#else
+#define CRC32_TABELA_CONST const
+#endif
+
+// Tabelas geradas por gerar_crc32_tabela.py: a fatia 0 e a tabela classica
+// de 256 entradas; a fatia k aplica mais k bytes zero
+#include "crc32_tabela.h"
+
+#define POLINOMIO 0xedb88320u
+
+/**
+ * Le 32 bits em little-endian sem exigir alinhamento (o M0+ nao faz
+ * leituras desalinhadas)
+ */
+static inline uint32_t ler_32(const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) |
+           ((uint32_t) p[3] << 24);
+}
+
+uint32_t crc32_update_bit(uint32_t estado, const void *dados, size_t tamanho) {
+    const uint8_t *p = dados;
+
+    while (tamanho--) {
+        estado ^= *p++;
+        for (int bit = 0; bit < 8; bit++) {
+            estado = (estado >> 1) ^ ((estado & 1u) ? POLINOMIO : 0u);
+        }
+    }
+    return estado;
+}
+
+uint32_t crc32_update_tabela(uint32_t estado, const void *dados, size_t tamanho) {
+    const uint8_t *p = dados;
+
+    while (tamanho--) {
+        estado = (estado >> 8) ^ crc32_tabela[0][(estado ^ *p++) & 0xffu];
+    }
+    return estado;
+}
+
+uint32_t crc32_update_slice4(uint32_t estado, const void *dados, size_t tamanho) {
+    const uint8_t *p = dados;
+
+    for (; tamanho >= 4; tamanho -= 4, p += 4) {
+        uint32_t a = estado ^ ler_32(p);
+        estado = crc32_tabela[3][a & 0xffu] ^ crc32_tabela[2][(a >> 8) & 0xffu] ^
+                 crc32_tabela[1][(a >> 16) & 0xffu] ^ crc32_tabela[0][a >> 24];
+    }
+    return crc32_update_tabela(estado, p, tamanho);
+}
+
+uint32_t crc32_update_slice8(uint32_t estado, const void *dados, size_t tamanho) {
+    const uint8_t *p = dados;
+
+    for (; tamanho >= 8; tamanho -= 8, p += 8) {
+        uint32_t a = estado ^ ler_32(p);
+        uint32_t b = ler_32(p + 4);
+        estado = crc32_tabela[7][a & 0xffu] ^ crc32_tabela[6][(a >> 8) & 0xffu] ^
+                 crc32_tabela[5][(a >> 16) & 0xffu] ^ crc32_tabela[4][a >> 24] ^
+                 crc32_tabela[3][b & 0xffu] ^ crc32_tabela[2][(b >> 8) & 0xffu] ^
+                 crc32_tabela[1][(b >> 16) & 0xffu] ^ crc32_tabela[0][b >> 24];
+    }
+    return crc32_update_tabela(estado, p, tamanho);
+}
+
+#if LIB_HARDWARE_DMA
+#include "hardware/dma.h"
+
+static int canal_crc = -1;
+static uint8_t destino_fixo;
+
+uint32_t crc32_update_dma(uint32_t estado, const void *dados, size_t tamanho) {
+    if (tamanho == 0) {
+        return estado;
+    }
+
+    if (canal_crc < 0) {
+        canal_crc = dma_claim_unused_channel(true);
+    }
+
+    // Bytes lidos em sequencia e escritos sempre no mesmo destino; sem DREQ
+    dma_channel_config c = dma_channel_get_default_config((uint) canal_crc);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_sniff_enable(&c, true);
+
+    dma_sniffer_set_output_reverse_enabled(false);
+    dma_sniffer_set_data_accumulator(crc32_inverter_bits(estado));
+    dma_sniffer_enable((uint) canal_crc, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+
+    dma_channel_configure((uint) canal_crc, &c, &destino_fixo, dados, (uint) tamanho, true);
+    dma_channel_wait_for_finish_blocking((uint) canal_crc);
+
+    uint32_t resultado = crc32_inverter_bits(dma_sniffer_get_data_accumulator());
+    dma_sniffer_disable();
+    return resultado;
+}
+#endif
+
+uint32_t crc32_update(uint32_t estado, const void *dados, size_t tamanho) {
+#if LIB_HARDWARE_DMA && CRC32_DMA_MINIMO > 0
+    if (tamanho >= CRC32_DMA_MINIMO) {
+        return crc32_update_dma(estado, dados, tamanho);
+    }
+#endif
+    return crc32_update_slice8(estado, dados, tamanho);
+}
@@ -0,0 +1,82 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC-32 (IEEE 802.3, polinomio refletido 0xEDB88320), o mesmo do modo
+ * DMA_SNIFF_CTRL_CALC_VALUE_CRC32R do sniffer de DMA.
+ *
+ * O estado e o registrador do CRC, sem a inversao final: comece com
+ * CRC32_INIT, encadeie quantas chamadas quiser e aplique crc32_final() no
+ * fim para obter o CRC-32 padrao. Um bloco seguido do proprio estado (em
+ * little-endian) resulta em estado 0, o que permite verificar um buffer
+ * com o CRC anexado.
+ *
+ *   uint32_t estado = crc32_update(CRC32_INIT, dados, tamanho);
+ *   uint32_t crc = crc32_final(estado);
+ */
+
+#define CRC32_INIT 0xffffffffu
+
+/**
+ * Coloca as tabelas (8 KB) na RAM em vez da flash, evitando as faltas de
+ * cache do XIP no slice-by-8
+ */
+#ifndef CRC32_TABELA_NA_RAM
+#define CRC32_TABELA_NA_RAM 0
+#endif
+
+/**
+ * Usa o sniffer de DMA em crc32_update para blocos a partir deste tamanho
+ * (0 desativa). So vale no RP2040, com hardware_dma.
+ */
+#ifndef CRC32_DMA_MINIMO
+#define CRC32_DMA_MINIMO 0
+#endif
+
+static inline uint32_t crc32_final(uint32_t estado) {
+    return ~estado;
+}
+
+/**
+ * Converte entre o estado de crc32_update e o acumulador do sniffer no modo
+ * CRC32R, que guarda o registrador com os bits na ordem inversa
+ */
+static inline uint32_t crc32_inverter_bits(uint32_t v) {
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0f0f0f0fu) | ((v & 0x0f0f0f0fu) << 4);
+    v = ((v >> 8) & 0x00ff00ffu) | ((v & 0x00ff00ffu) << 8);
+    return (v >> 16) | (v << 16);
+}
+
+/**
+ * Atualiza o CRC com o caminho mais rapido disponivel: slice-by-8 ou, para
+ * blocos grandes com CRC32_DMA_MINIMO, o sniffer de DMA
+ * @param estado Estado anterior (CRC32_INIT no primeiro bloco)
+ * @param dados Bytes a processar
+ * @param tamanho Quantidade de bytes
+ * @return Novo estado
+ */
+uint32_t crc32_update(uint32_t estado, const void *dados, size_t tamanho);
+
+/**
+ * Caminhos individuais, com o mesmo contrato de crc32_update. Servem para
+ * comparacao e benchmark; prefira crc32_update.
+ */
+uint32_t crc32_update_bit(uint32_t estado, const void *dados, size_t tamanho);
+uint32_t crc32_update_tabela(uint32_t estado, const void *dados, size_t tamanho);
+uint32_t crc32_update_slice4(uint32_t estado, const void *dados, size_t tamanho);
+uint32_t crc32_update_slice8(uint32_t estado, const void *dados, size_t tamanho);
+
+/**
+ * Calcula com o sniffer de DMA (transferencias de 8 bits para um destino
+ * fixo), esperando o fim. Reserva um canal de DMA na primeira chamada.
+ * Nao deve ser usada ao mesmo tempo por dois cores. Existe apenas no
+ * RP2040, com hardware_dma.
+ */
+uint32_t crc32_update_dma(uint32_t estado, const void *dados, size_t tamanho);
+
+#endif
@@ -0,0 +1,220 @@
+#include "crc_dma.h"
+#include "crc32.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include <stddef.h>
+
+/**
+ * Item da fila: uma lista do usuario ou um bloco unico (com terminador)
+ */
+typedef struct {
+    const crc_dma_bloco_t *lista;
+    crc_dma_bloco_t unico[2];
+} item_crc_t;
+
+static uint canal_dados;
+static uint canal_controle;
+static spin_lock_t *trava;
+
+static item_crc_t fila[CRC_DMA_FILA];
+static uint32_t inicio = 0;
+static uint32_t tamanho = 0;
+static bool processando = false;
+
+static bool sessao_aberta = false;
+static bool finalizando = false;
+static crc_dma_modo_t modo_atual;
+static crc_dma_callback_t callback_final;
+static void *contexto_final;
+
+/**
+ * Dispara o canal de controle com a lista do primeiro item. Chamada com a trava.
+ */
+static void processar_proximo(void) {
+    processando = tamanho > 0;
+    if (processando) {
+        const item_crc_t *item = &fila[inicio];
+        dma_channel_set_read_addr(canal_controle, item->lista, true);
+    }
+}
+
+/**
+ * Le o resultado e fecha a sessao. Chamada com a trava.
+ */
+static uint32_t encerrar_sessao(void) {
+    uint32_t resultado = dma_sniffer_get_data_accumulator();
+
+    if (modo_atual == CRC_DMA_CRC32) {
+        resultado = crc32_inverter_bits(resultado);
+    } else if (modo_atual == CRC_DMA_CRC16_CCITT) {
+        resultado &= 0xffffu;
+    }
+
+    dma_sniffer_disable();
+    sessao_aberta = false;
+    finalizando = false;
+    return resultado;
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_0: com irq_quiet, o canal de dados so
+ * sinaliza no gatilho nulo do fim de cada lista
+ */
+static void irq_crc_dma(void) {
+    if (!dma_channel_get_irq0_status(canal_dados)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(canal_dados);
+
+    crc_dma_callback_t callback = NULL;
+    void *contexto = NULL;
+    uint32_t resultado = 0;
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    inicio = (inicio + 1u) % CRC_DMA_FILA;
+    tamanho--;
+    processar_proximo();
+
+    if (!processando && finalizando) {
+        callback = callback_final;
+        contexto = contexto_final;
+        resultado = encerrar_sessao();
+    }
+    spin_unlock(trava, salvo);
+
+    if (callback) {
+        callback(resultado, contexto);
+    }
+}
+
+void crc_dma_init(void) {
+    trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+    canal_controle = (uint) dma_claim_unused_channel(true);
+    canal_dados = (uint) dma_claim_unused_channel(true);
+
+    // Controle: {tamanho, endereco} nos dois ultimos registradores do alias 3
+    dma_channel_config c = dma_channel_get_default_config(canal_controle);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 3);
+    dma_channel_configure(canal_controle, &c, &dma_hw->ch[canal_dados].al3_transfer_count,
+                          NULL, 2, false);
+
+    // Dados: bytes lidos em sequencia para um destino fixo, sem DREQ; o
+    // sniffer observa as leituras
+    static uint8_t destino_fixo;
+    c = dma_channel_get_default_config(canal_dados);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_sniff_enable(&c, true);
+    channel_config_set_chain_to(&c, canal_controle);
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_configure(canal_dados, &c, &destino_fixo, NULL, 0, false);
+
+    irq_add_shared_handler(DMA_IRQ_0, irq_crc_dma, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    dma_channel_set_irq0_enabled(canal_dados, true);
+}
+
+bool crc_dma_iniciar(crc_dma_modo_t modo, uint32_t semente) {
+    static const uint modos_sniffer[] = {
+        [CRC_DMA_CRC32] = DMA_SNIFF_CTRL_CALC_VALUE_CRC32R,
+        [CRC_DMA_CRC16_CCITT] = DMA_SNIFF_CTRL_CALC_VALUE_CRC16,
+        [CRC_DMA_SOMA] = DMA_SNIFF_CTRL_CALC_VALUE_SUM,
+    };
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    if (sessao_aberta) {
+        spin_unlock(trava, salvo);
+        return false;
+    }
+
+    sessao_aberta = true;
+    finalizando = false;
+    modo_atual = modo;
+
+    dma_sniffer_set_output_reverse_enabled(false);
+    dma_sniffer_set_data_accumulator(modo == CRC_DMA_CRC32 ? crc32_inverter_bits(semente) : semente);
+    dma_sniffer_enable(canal_dados, modos_sniffer[modo], true);
+
+    spin_unlock(trava, salvo);
+    return true;
+}
+
+/**
+ * Reserva o proximo item da fila. Chamada com a trava.
+ * @return NULL sem sessao aberta ou com a fila cheia
+ */
+static item_crc_t *reservar(void) {
+    if (!sessao_aberta || finalizando || tamanho >= CRC_DMA_FILA) {
+        return NULL;
+    }
+    return &fila[(inicio + tamanho) % CRC_DMA_FILA];
+}
+
+bool crc_dma_adicionar(const void *dados, uint32_t tamanho_bloco) {
+    // Um bloco de tamanho 0 seria confundido com o fim da lista
+    if (tamanho_bloco == 0) {
+        return false;
+    }
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    item_crc_t *item = reservar();
+    if (item) {
+        item->unico[0] = (crc_dma_bloco_t) { .tamanho = tamanho_bloco, .dados = dados };
+        item->unico[1] = (crc_dma_bloco_t) { .tamanho = 0, .dados = NULL };
+        item->lista = item->unico;
+        tamanho++;
+        if (!processando) {
+            processar_proximo();
+        }
+    }
+    spin_unlock(trava, salvo);
+    return item != NULL;
+}
+
+bool crc_dma_adicionar_lista(const crc_dma_bloco_t *lista) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    item_crc_t *item = reservar();
+    if (item) {
+        item->lista = lista;
+        tamanho++;
+        if (!processando) {
+            processar_proximo();
+        }
+    }
+    spin_unlock(trava, salvo);
+    return item != NULL;
+}
+
+bool crc_dma_finalizar(crc_dma_callback_t callback, void *contexto) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    if (!sessao_aberta || finalizando) {
+        spin_unlock(trava, salvo);
+        return false;
+    }
+
+    callback_final = callback;
+    contexto_final = contexto;
+    finalizando = true;
+
+    // Nada pendente: termina aqui mesmo
+    bool terminou = !processando;
+    uint32_t resultado = terminou ? encerrar_sessao() : 0;
+    spin_unlock(trava, salvo);
+
+    if (terminou && callback) {
+        callback(resultado, contexto);
+    }
+    return true;
+}
+
+bool crc_dma_ocupado(void) {
+    uint32_t salvo = spin_lock_blocking(trava);
+    bool ocupado = sessao_aberta || processando;
+    spin_unlock(trava, salvo);
+    return ocupado;
+}
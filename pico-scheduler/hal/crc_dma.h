@@ -0,0 +1,88 @@
+#ifndef CRC_DMA_H
+#define CRC_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * CRC/checksum em segundo plano com o sniffer de DMA.
+ *
+ * Uma sessao (crc_dma_iniciar ... crc_dma_finalizar) recebe blocos aos
+ * poucos ou listas de blocos, e o acumulador do sniffer segue de um bloco
+ * para o outro. Um canal de controle carrega cada bloco no canal de dados
+ * (como no exemplo dma/control_blocks), sem CPU por byte; o resultado
+ * chega por callback na IRQ de DMA (DMA_IRQ_0, handler compartilhado).
+ *
+ * Ha um unico sniffer no RP2040: so uma sessao por vez, e ela nao deve ser
+ * misturada com crc32_update_dma.
+ */
+
+/**
+ * Numero de blocos (ou listas) pendentes
+ */
+#ifndef CRC_DMA_FILA
+#define CRC_DMA_FILA 8
+#endif
+
+typedef enum {
+    CRC_DMA_CRC32 = 0,      // CRC-32 refletido, compativel com o estado de crc32.h
+    CRC_DMA_CRC16_CCITT,    // CRC-16-CCITT (0x1021), sem reflexao
+    CRC_DMA_SOMA,           // soma simples dos bytes, modulo 2^32
+} crc_dma_modo_t;
+
+/**
+ * Bloco de uma lista. A ordem dos campos e a dos registradores do alias 3
+ * do canal de dados; uma lista termina com {0, NULL}.
+ */
+typedef struct {
+    uint32_t tamanho;
+    const void *dados;
+} crc_dma_bloco_t;
+
+/**
+ * Chamada na IRQ de DMA quando todos os blocos da sessao foram processados
+ * @param resultado Estado final: para CRC32, aplique crc32_final(); para
+ *                  CRC16, os 16 bits baixos
+ */
+typedef void (*crc_dma_callback_t)(uint32_t resultado, void *contexto);
+
+/**
+ * Reserva os dois canais de DMA e instala o handler no core atual
+ */
+void crc_dma_init(void);
+
+/**
+ * Comeca uma sessao
+ * @param modo Calculo a fazer
+ * @param semente Estado inicial (ex.: CRC32_INIT, 0xffff para CRC16-CCITT, 0)
+ * @return false se ja houver uma sessao em andamento
+ */
+bool crc_dma_iniciar(crc_dma_modo_t modo, uint32_t semente);
+
+/**
+ * Enfileira um bloco. O buffer deve ficar intacto ate a sessao terminar.
+ * Pode ser chamada de IRQs (ex.: a cada quadro recebido pela UART).
+ * @return false sem sessao, com a fila cheia ou com tamanho 0
+ */
+bool crc_dma_adicionar(const void *dados, uint32_t tamanho);
+
+/**
+ * Enfileira uma lista de blocos terminada por {0, NULL}, processada toda
+ * pelo DMA. A lista e os buffers devem ficar intactos ate a sessao terminar.
+ * @return false sem sessao ou com a fila cheia
+ */
+bool crc_dma_adicionar_lista(const crc_dma_bloco_t *lista);
+
+/**
+ * Encerra a sessao: o callback e chamado quando os blocos pendentes
+ * terminarem (na hora, se ja tiverem terminado)
+ * @return false sem sessao
+ */
+bool crc_dma_finalizar(crc_dma_callback_t callback, void *contexto);
+
+/**
+ * Indica se ha uma sessao aberta ou com blocos pendentes
+ */
+bool crc_dma_ocupado(void);
+
+#endif
@@ -0,0 +1,137 @@
+#include "dma_memcpy_crc.h"
+#include "crc32.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "pico/time.h"
+
+static uint canal;
+static volatile bool ocupado = false;
+
+static dma_memcpy_crc_callback_t callback_atual;
+static void *contexto_atual;
+
+static uint32_t inicio_us;
+static dma_memcpy_crc_medida_t ultima;
+
+/**
+ * Maior transferencia que o alinhamento de origem, destino e tamanho permite
+ */
+static enum dma_channel_transfer_size escolher_largura(const void *destino, const void *origem,
+                                                       size_t tamanho) {
+    uintptr_t bits = (uintptr_t) destino | (uintptr_t) origem | tamanho;
+    if ((bits & 3u) == 0) {
+        return DMA_SIZE_32;
+    }
+    if ((bits & 1u) == 0) {
+        return DMA_SIZE_16;
+    }
+    return DMA_SIZE_8;
+}
+
+/**
+ * Configura o sniffer e dispara o canal
+ */
+static void iniciar(void *destino, const void *origem, size_t tamanho, uint32_t estado,
+                    bool com_irq) {
+    enum dma_channel_transfer_size largura = escolher_largura(destino, origem, tamanho);
+
+    dma_channel_config c = dma_channel_get_default_config(canal);
+    channel_config_set_transfer_data_size(&c, largura);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_sniff_enable(&c, true);
+
+    dma_sniffer_set_output_reverse_enabled(false);
+    dma_sniffer_set_data_accumulator(crc32_inverter_bits(estado));
+    dma_sniffer_enable(canal, DMA_SNIFF_CTRL_CALC_VALUE_CRC32R, true);
+
+    ultima.bytes = (uint32_t) tamanho;
+    ultima.largura_bits = (uint8_t) (8u << largura);
+    dma_channel_set_irq0_enabled(canal, com_irq);
+
+    inicio_us = time_us_32();
+    dma_channel_configure(canal, &c, destino, origem, (uint) (tamanho >> largura), true);
+}
+
+/**
+ * Le o CRC, registra a medida e libera o sniffer
+ */
+static uint32_t concluir(void) {
+    ultima.tempo_us = time_us_32() - inicio_us;
+    uint32_t resultado = crc32_inverter_bits(dma_sniffer_get_data_accumulator());
+    dma_sniffer_disable();
+    return resultado;
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_0 (so as copias assincronas o habilitam)
+ */
+static void irq_memcpy_crc(void) {
+    if (!dma_channel_get_irq0_status(canal)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(canal);
+
+    uint32_t resultado = concluir();
+    dma_memcpy_crc_callback_t callback = callback_atual;
+    void *contexto = contexto_atual;
+    ocupado = false;
+
+    if (callback) {
+        callback(resultado, contexto);
+    }
+}
+
+void dma_memcpy_crc_init(void) {
+    canal = (uint) dma_claim_unused_channel(true);
+    irq_add_shared_handler(DMA_IRQ_0, irq_memcpy_crc, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+bool dma_memcpy_crc(void *destino, const void *origem, size_t tamanho, uint32_t estado,
+                    uint32_t *crc) {
+    if (ocupado) {
+        return false;
+    }
+
+    uint32_t resultado = estado;
+    if (tamanho > 0) {
+        iniciar(destino, origem, tamanho, estado, false);
+        dma_channel_wait_for_finish_blocking(canal);
+        resultado = concluir();
+    }
+
+    if (crc) {
+        *crc = resultado;
+    }
+    return true;
+}
+
+bool dma_memcpy_crc_async(void *destino, const void *origem, size_t tamanho, uint32_t estado,
+                          dma_memcpy_crc_callback_t callback, void *contexto) {
+    if (ocupado) {
+        return false;
+    }
+
+    // Nada a copiar: o estado nao muda e o callback e chamado na hora
+    if (tamanho == 0) {
+        if (callback) {
+            callback(estado, contexto);
+        }
+        return true;
+    }
+
+    callback_atual = callback;
+    contexto_atual = contexto;
+    ocupado = true;
+    iniciar(destino, origem, tamanho, estado, true);
+    return true;
+}
+
+bool dma_memcpy_crc_ocupado(void) {
+    return ocupado;
+}
+
+void dma_memcpy_crc_ultima_medida(dma_memcpy_crc_medida_t *medida) {
+    *medida = ultima;
+}
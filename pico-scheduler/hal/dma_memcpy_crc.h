@@ -0,0 +1,78 @@
+#ifndef DMA_MEMCPY_CRC_H
+#define DMA_MEMCPY_CRC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Copia por DMA calculando o CRC-32 dos dados na mesma passada pelo
+ * barramento: o sniffer observa as leituras do canal enquanto ele escreve
+ * no destino, entao os dados sao lidos uma unica vez.
+ *
+ * A largura das transferencias (8, 16 ou 32 bits) e a maior que o
+ * alinhamento de origem, destino e tamanho permitem. No modo CRC32R o
+ * sniffer consome cada palavra a partir do bit menos significativo, o que
+ * equivale aos bytes em little-endian: o CRC e o mesmo em qualquer largura
+ * e o mesmo de crc32_update.
+ *
+ * Usa o sniffer de DMA, que e unico: nao misture com crc_dma nem com
+ * crc32_update_dma enquanto uma copia estiver em andamento, nem chame
+ * de dois cores ao mesmo tempo.
+ */
+
+/**
+ * Chamada na IRQ de DMA (DMA_IRQ_0) quando a copia termina
+ * @param estado Estado do CRC (aplique crc32_final() para o CRC-32 padrao)
+ */
+typedef void (*dma_memcpy_crc_callback_t)(uint32_t estado, void *contexto);
+
+/**
+ * Medida da ultima copia concluida
+ */
+typedef struct {
+    uint32_t bytes;
+    uint32_t tempo_us;
+    uint8_t largura_bits;
+} dma_memcpy_crc_medida_t;
+
+/**
+ * Vazao da medida, em KB/s (0 se a copia levou menos de 1 us)
+ */
+static inline uint32_t dma_memcpy_crc_kbps(const dma_memcpy_crc_medida_t *medida) {
+    return medida->tempo_us ? (uint32_t) ((uint64_t) medida->bytes * 1000u / medida->tempo_us) : 0;
+}
+
+/**
+ * Reserva o canal de DMA e instala o handler no core atual
+ */
+void dma_memcpy_crc_init(void);
+
+/**
+ * Copia `tamanho` bytes e espera o fim
+ * @param crc Recebe o estado do CRC apos os dados (pode ser NULL)
+ * @param estado Estado inicial (CRC32_INIT ou o de uma copia anterior)
+ * @return false se houver uma copia assincrona em andamento
+ */
+bool dma_memcpy_crc(void *destino, const void *origem, size_t tamanho, uint32_t estado,
+                    uint32_t *crc);
+
+/**
+ * Inicia a copia e retorna; o callback recebe o CRC no fim. Os buffers
+ * devem ficar intactos ate la.
+ * @return false se houver outra copia em andamento
+ */
+bool dma_memcpy_crc_async(void *destino, const void *origem, size_t tamanho, uint32_t estado,
+                          dma_memcpy_crc_callback_t callback, void *contexto);
+
+/**
+ * Indica se ha uma copia em andamento
+ */
+bool dma_memcpy_crc_ocupado(void);
+
+/**
+ * Copia a medida (bytes, tempo e largura) da ultima copia concluida
+ */
+void dma_memcpy_crc_ultima_medida(dma_memcpy_crc_medida_t *medida);
+
+#endif
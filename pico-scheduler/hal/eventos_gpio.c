@@ -0,0 +1,268 @@
+#include "eventos_gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+
+#if (EVENTOS_GPIO_FILA & (EVENTOS_GPIO_FILA - 1)) != 0
+#error "EVENTOS_GPIO_FILA deve ser potencia de 2"
+#endif
+
+#define BORDAS (GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+
+static evento_gpio_t fila[EVENTOS_GPIO_FILA];
+
+/**
+ * Contadores livres (nunca reiniciam); a posicao e contador % tamanho
+ */
+static uint32_t inicio = 0;
+static uint32_t fim = 0;
+static volatile uint32_t descartados = 0;
+
+/**
+ * Spinlock de hardware: a fila e escrita na IRQ do core 0 e lida por
+ * tarefas em qualquer core
+ */
+static spin_lock_t *trava = NULL;
+
+static eventos_gpio_callback_t aviso = NULL;
+static void *contexto_aviso = NULL;
+
+static uint32_t mascara_pinos = 0;
+static volatile uint32_t estaveis = 0;
+
+/**
+ * Pinos em debounce: IRQ desabilitada ate o prazo
+ */
+static uint32_t mascara_pendentes = 0;
+static uint32_t debounce_us[NUM_BANK0_GPIOS];
+static uint32_t primeira_borda_us[NUM_BANK0_GPIOS];
+static uint32_t prazo_us[NUM_BANK0_GPIOS];
+
+/**
+ * Alarme do prazo mais proximo entre os pinos pendentes (0 = nenhum)
+ */
+static alarm_id_t alarme = 0;
+static uint32_t prazo_alarme_us;
+
+/**
+ * Registra o novo nivel estavel e coloca o evento na fila
+ */
+static void publicar(uint pino, bool nivel, uint32_t instante_us) {
+    if (nivel) {
+        estaveis |= 1u << pino;
+    } else {
+        estaveis &= ~(1u << pino);
+    }
+
+    bool enfileirado = false;
+    uint32_t salvo = spin_lock_blocking(trava);
+    if (fim - inicio >= EVENTOS_GPIO_FILA) {
+        descartados++;
+    } else {
+        fila[fim++ % EVENTOS_GPIO_FILA] = (evento_gpio_t) {
+            .instante_us = instante_us,
+            .pino = (uint8_t) pino,
+            .nivel = nivel,
+        };
+        enfileirado = true;
+    }
+    spin_unlock(trava, salvo);
+
+    if (enfileirado && aviso) {
+        aviso(contexto_aviso);
+    }
+}
+
+static int64_t fim_debounce(alarm_id_t id, void *dados);
+
+/**
+ * Sem alarme livre no pool: confirma os pinos pendentes ja, sem debounce, e
+ * reabilita a IRQ deles, em vez de deixar as entradas mortas
+ */
+static void confirmar_pendentes(void) {
+    for (uint pino = 0; pino < NUM_BANK0_GPIOS; pino++) {
+        if (!(mascara_pendentes & (1u << pino))) {
+            continue;
+        }
+
+        mascara_pendentes &= ~(1u << pino);
+        gpio_acknowledge_irq(pino, BORDAS);
+        gpio_set_irq_enabled(pino, BORDAS, true);
+
+        // Uma borda depois do reconhecimento gera uma nova IRQ
+        bool nivel = gpio_get(pino);
+        if (nivel != ((estaveis >> pino) & 1u)) {
+            publicar(pino, nivel, primeira_borda_us[pino]);
+        }
+    }
+}
+
+/**
+ * Garante um alarme ate `prazo`: so troca o atual se ele vier depois
+ */
+static void agendar(uint32_t prazo) {
+    if (alarme > 0) {
+        if ((int32_t) (prazo - prazo_alarme_us) >= 0) {
+            return;
+        }
+        cancel_alarm(alarme);
+    }
+
+    int32_t falta = (int32_t) (prazo - time_us_32());
+    prazo_alarme_us = prazo;
+    alarme = add_alarm_in_us(falta > 0 ? (uint64_t) falta : 0, fim_debounce, NULL, true);
+
+    if (alarme < 0) {
+        alarme = 0;
+        confirmar_pendentes();
+    }
+}
+
+/**
+ * Inicia o debounce de um pino a partir da borda em `agora`
+ */
+static void iniciar_debounce(uint pino, uint32_t agora) {
+    gpio_set_irq_enabled(pino, BORDAS, false);
+    mascara_pendentes |= 1u << pino;
+    primeira_borda_us[pino] = agora;
+    prazo_us[pino] = agora + debounce_us[pino];
+}
+
+/**
+ * Confirma os pinos cujo prazo venceu e reagenda para o proximo
+ */
+static int64_t fim_debounce(alarm_id_t id, void *dados) {
+    (void) dados;
+    alarme = 0;
+
+    uint32_t agora = time_us_32();
+    uint32_t entradas = gpio_get_all();
+    uint32_t menor_falta = UINT32_MAX;
+
+    for (uint pino = 0; pino < NUM_BANK0_GPIOS; pino++) {
+        if (!(mascara_pendentes & (1u << pino))) {
+            continue;
+        }
+
+        int32_t falta = (int32_t) (prazo_us[pino] - agora);
+        if (falta > 0) {
+            menor_falta = MIN(menor_falta, (uint32_t) falta);
+            continue;
+        }
+
+        mascara_pendentes &= ~(1u << pino);
+        bool nivel = (entradas >> pino) & 1u;
+        if (nivel != ((estaveis >> pino) & 1u)) {
+            publicar(pino, nivel, primeira_borda_us[pino]);
+        }
+
+        // Bordas durante o debounce ja estao na leitura acima; se o nivel
+        // mudou depois dela, comeca um novo debounce em vez de perde-lo
+        gpio_acknowledge_irq(pino, BORDAS);
+        gpio_set_irq_enabled(pino, BORDAS, true);
+        if (gpio_get(pino) != nivel) {
+            iniciar_debounce(pino, agora);
+            menor_falta = MIN(menor_falta, debounce_us[pino]);
+        }
+    }
+
+    if (menor_falta == UINT32_MAX) {
+        return 0;
+    }
+
+    // Positivo: reagenda a partir do retorno do callback, com o mesmo id.
+    // O prazo registrado usa o instante do retorno; o disparo real pode vir
+    // alguns microssegundos depois, e um pino que vencer nesse intervalo e
+    // confirmado nele
+    alarme = id;
+    prazo_alarme_us = time_us_32() + menor_falta;
+    return (int64_t) menor_falta;
+}
+
+/**
+ * Handler compartilhado de IO_IRQ_BANK0: trata apenas os pinos registrados
+ * e deixa os demais para os outros handlers
+ */
+static void irq_eventos_gpio(void) {
+    uint32_t agora = time_us_32();
+    uint32_t mascara = mascara_pinos & ~mascara_pendentes;
+
+    for (uint pino = 0; pino < NUM_BANK0_GPIOS; pino++) {
+        if (!(mascara & (1u << pino))) {
+            continue;
+        }
+
+        uint32_t eventos = gpio_get_irq_event_mask(pino) & BORDAS;
+        if (!eventos) {
+            continue;
+        }
+        gpio_acknowledge_irq(pino, eventos);
+
+        if (debounce_us[pino] == 0) {
+            // Com as duas bordas travadas, vale o nivel atual
+            bool nivel = eventos == BORDAS ? gpio_get(pino) : (eventos == GPIO_IRQ_EDGE_RISE);
+            if (nivel != ((estaveis >> pino) & 1u)) {
+                publicar(pino, nivel, agora);
+            }
+            continue;
+        }
+
+        iniciar_debounce(pino, agora);
+        agendar(prazo_us[pino]);
+    }
+}
+
+void eventos_gpio_init(void) {
+    trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+
+    irq_add_shared_handler(IO_IRQ_BANK0, irq_eventos_gpio, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void eventos_gpio_set_aviso(eventos_gpio_callback_t novo_aviso, void *contexto) {
+    uint32_t salvo = save_and_disable_interrupts();
+    aviso = novo_aviso;
+    contexto_aviso = contexto;
+    restore_interrupts(salvo);
+}
+
+bool eventos_gpio_adicionar(uint pino, uint32_t debounce) {
+    if (pino >= NUM_BANK0_GPIOS || (mascara_pinos & (1u << pino))) {
+        return false;
+    }
+
+    gpio_init(pino);
+    gpio_set_dir(pino, GPIO_IN);
+    debounce_us[pino] = debounce;
+
+    // O nivel de partida e o atual; so mudancas a partir daqui geram eventos
+    uint32_t salvo = save_and_disable_interrupts();
+    if (gpio_get(pino)) {
+        estaveis |= 1u << pino;
+    }
+    mascara_pinos |= 1u << pino;
+    gpio_acknowledge_irq(pino, BORDAS);
+    gpio_set_irq_enabled(pino, BORDAS, true);
+    restore_interrupts(salvo);
+    return true;
+}
+
+bool eventos_gpio_proximo(evento_gpio_t *evento) {
+    bool ha_evento = false;
+
+    uint32_t salvo = spin_lock_blocking(trava);
+    if (inicio != fim) {
+        *evento = fila[inicio++ % EVENTOS_GPIO_FILA];
+        ha_evento = true;
+    }
+    spin_unlock(trava, salvo);
+    return ha_evento;
+}
+
+uint32_t eventos_gpio_estaveis(void) {
+    return estaveis & mascara_pinos;
+}
+
+uint32_t eventos_gpio_descartados(void) {
+    return descartados;
+}
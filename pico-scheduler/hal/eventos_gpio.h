@@ -0,0 +1,118 @@
+#ifndef EVENTOS_GPIO_H
+#define EVENTOS_GPIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/gpio.h"
+
+/**
+ * Entradas digitais por eventos, sem varredura: cada borda gera uma IRQ
+ * (IO_IRQ_BANK0, handler compartilhado com as corrotinas e os callbacks do
+ * SDK) marcada com o instante do temporizador de hardware.
+ *
+ * Com debounce, a primeira borda desabilita a IRQ do pino e agenda a
+ * confirmacao para debounce_us depois; se o nivel entao for diferente do
+ * ultimo nivel estavel, o evento entra na fila com o instante da primeira
+ * borda. Um unico alarme atende todos os pinos em debounce (sempre o prazo
+ * mais proximo), entao o numero de entradas nao esgota o pool de alarmes.
+ * Se o pool estiver cheio, os pinos pendentes sao confirmados na hora, sem
+ * debounce, e a IRQ deles volta a ser habilitada.
+ *
+ * Os eventos sao consumidos fora da IRQ. Um aviso opcional, chamado na
+ * IRQ a cada evento enfileirado, acorda quem os consome, sem varredura
+ * periodica; por exemplo, uma corrotina do escalonador:
+ *
+ *   static tarefa_handle_t botoes;
+ *
+ *   static void avisar(void *contexto) {
+ *       scheduler_notify(botoes);
+ *   }
+ *
+ *   corrotina_estado_t tratar_botoes(corrotina_t *co, void *dados) {
+ *       evento_gpio_t evento;
+ *       CO_BEGIN(co);
+ *       while (true) {
+ *           while (eventos_gpio_proximo(&evento)) { ... }
+ *           CO_AWAIT_NOTIFY(co, 0);
+ *       }
+ *       CO_END(co);
+ *   }
+ *
+ *   botoes = scheduler_add_coroutine(tratar_botoes, NULL, SCHEDULER_CORE_QUALQUER);
+ *   eventos_gpio_set_aviso(avisar, NULL);
+ *
+ * Use no core 0, que recebe as IRQs de GPIO e do pool de alarmes padrao.
+ */
+
+#if NUM_BANK0_GPIOS > 32
+#error "eventos_gpio usa mascaras de 32 bits"
+#endif
+
+/**
+ * Numero de eventos na fila (potencia de 2)
+ */
+#ifndef EVENTOS_GPIO_FILA
+#define EVENTOS_GPIO_FILA 32
+#endif
+
+/**
+ * Uma mudanca de nivel confirmada
+ */
+typedef struct {
+    uint32_t instante_us; // primeira borda (time_us_32, na IRQ)
+    uint8_t pino;
+    uint8_t nivel;        // novo nivel: 1 = borda de subida, 0 = descida
+} evento_gpio_t;
+
+/**
+ * Aviso de evento enfileirado, chamado na IRQ
+ */
+typedef void (*eventos_gpio_callback_t)(void *contexto);
+
+/**
+ * Instala o handler de IRQ. Chame antes de eventos_gpio_adicionar.
+ */
+void eventos_gpio_init(void);
+
+/**
+ * Define o aviso chamado (na IRQ) a cada evento que entra na fila
+ * @param aviso Funcao curta, segura em IRQ (NULL desativa)
+ * @param contexto Repassado ao aviso
+ */
+void eventos_gpio_set_aviso(eventos_gpio_callback_t aviso, void *contexto);
+
+/**
+ * Passa a gerar eventos para um pino, configurado como entrada. Os
+ * resistores de pull-up/pull-down ficam a cargo de quem chama e devem ser
+ * configurados antes, pois o nivel de partida e lido aqui.
+ * @param pino Pino de GPIO
+ * @param debounce_us Tempo que o nivel deve ficar estavel (0 = sem debounce)
+ * @return false se o pino ja estiver em uso
+ */
+bool eventos_gpio_adicionar(uint pino, uint32_t debounce_us);
+
+/**
+ * Retira o proximo evento da fila. Pode ser chamada de qualquer core.
+ * @return false se a fila estiver vazia
+ */
+bool eventos_gpio_proximo(evento_gpio_t *evento);
+
+/**
+ * Nivel atual, sem debounce, de todos os pinos numa unica leitura de
+ * sio_hw->gpio_in (bit n = pino n)
+ */
+static inline uint32_t eventos_gpio_entradas(void) {
+    return gpio_get_all();
+}
+
+/**
+ * Ultimo nivel confirmado (apos o debounce) dos pinos registrados
+ */
+uint32_t eventos_gpio_estaveis(void);
+
+/**
+ * Quantidade de eventos descartados porque a fila estava cheia
+ */
+uint32_t eventos_gpio_descartados(void);
+
+#endif
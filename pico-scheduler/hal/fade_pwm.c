@@ -0,0 +1,128 @@
+#include "fade_pwm.h"
+#include <math.h>
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#define PI_F 3.14159265f
+
+/**
+ * Fades em laco registrados no handler de DMA_IRQ_0, pelo canal
+ */
+static fade_pwm_t *instancias[NUM_DMA_CHANNELS];
+static bool handler_instalado = false;
+
+float fade_pwm_linear(float t) {
+    return t;
+}
+
+float fade_pwm_quadratica(float t) {
+    return t * t;
+}
+
+float fade_pwm_suave(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+float fade_pwm_seno(float t) {
+    return sinf(t * PI_F);
+}
+
+/**
+ * No laco o canal para depois de 2^32 - 1 passos: reinicia na mesma
+ * posicao do anel
+ */
+static void irq_fade_pwm(void) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        fade_pwm_t *fade = instancias[i];
+        if (fade && dma_channel_get_irq0_status(i)) {
+            dma_channel_acknowledge_irq0(i);
+            if (fade->em_laco) {
+                dma_channel_set_trans_count(i, UINT32_MAX, true);
+            }
+        }
+    }
+}
+
+void fade_pwm_init(fade_pwm_t *fade, uint fatia, uint32_t *tabela, uint32_t passos) {
+    fade->fatia = fatia;
+    fade->tabela = tabela;
+    fade->passos = passos;
+    fade->em_laco = false;
+    fade->canal = (uint) dma_claim_unused_channel(true);
+
+    for (uint32_t i = 0; i < passos; i++) {
+        tabela[i] = 0;
+    }
+
+    if (!handler_instalado) {
+        irq_add_shared_handler(DMA_IRQ_0, irq_fade_pwm, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        handler_instalado = true;
+    }
+    instancias[fade->canal] = fade;
+}
+
+void fade_pwm_curva(fade_pwm_t *fade, enum pwm_chan canal, fade_pwm_curva_t curva,
+                    float de, float ate, bool vai_e_volta) {
+    // Nivel acima do wrap deixa a saida sempre ligada
+    float maximo = (float) pwm_hw->slice[fade->fatia].top + 1.0f;
+    uint32_t deslocamento = canal == PWM_CHAN_B ? 16 : 0;
+    uint32_t ida = vai_e_volta ? (fade->passos + 1) / 2 : fade->passos;
+
+    for (uint32_t i = 0; i < fade->passos; i++) {
+        // Progresso de 0 a 1 na ida e de volta a 0 na segunda metade
+        uint32_t posicao = i < ida ? i : fade->passos - 1 - i;
+        float t = ida > 1 ? (float) posicao / (float) (ida - 1) : 1.0f;
+
+        float brilho = de + (ate - de) * curva(t);
+        brilho = brilho < 0.0f ? 0.0f : (brilho > 1.0f ? 1.0f : brilho);
+        uint32_t nivel = (uint32_t) (powf(brilho, FADE_PWM_GAMA) * maximo + 0.5f);
+        if (nivel > 0xffffu) {
+            nivel = 0xffffu;
+        }
+
+        fade->tabela[i] = (fade->tabela[i] & ~(0xffffu << deslocamento)) | (nivel << deslocamento);
+    }
+}
+
+bool fade_pwm_iniciar(fade_pwm_t *fade, bool em_laco) {
+    uint32_t bytes = fade->passos * sizeof(uint32_t);
+    uint bits_anel = 0;
+    while ((1u << bits_anel) < bytes) {
+        bits_anel++;
+    }
+
+    if (em_laco && ((1u << bits_anel) != bytes || bits_anel > 15 ||
+                    ((uintptr_t) fade->tabela & (bytes - 1)) != 0)) {
+        return false;
+    }
+
+    fade_pwm_parar(fade);
+    fade->em_laco = em_laco;
+
+    dma_channel_config c = dma_channel_get_default_config(fade->canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pwm_get_dreq(fade->fatia));
+    if (em_laco) {
+        channel_config_set_ring(&c, false, bits_anel);
+    }
+
+    dma_channel_set_irq0_enabled(fade->canal, em_laco);
+    dma_channel_configure(fade->canal, &c, &pwm_hw->slice[fade->fatia].cc, fade->tabela,
+                          em_laco ? UINT32_MAX : fade->passos, true);
+    return true;
+}
+
+void fade_pwm_parar(fade_pwm_t *fade) {
+    // Sem IRQ durante o abort (errata RP2040-E13)
+    dma_channel_set_irq0_enabled(fade->canal, false);
+    dma_channel_abort(fade->canal);
+    dma_channel_acknowledge_irq0(fade->canal);
+    fade->em_laco = false;
+}
+
+bool fade_pwm_ativo(const fade_pwm_t *fade) {
+    return dma_channel_is_busy(fade->canal);
+}
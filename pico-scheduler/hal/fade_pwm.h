@@ -0,0 +1,101 @@
+#ifndef FADE_PWM_H
+#define FADE_PWM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/pwm.h"
+
+/**
+ * Fade de LEDs sem CPU: um canal de DMA escreve o registrador CC de uma
+ * fatia de PWM a cada wrap do contador (DREQ de wrap da fatia), lendo uma
+ * tabela calculada na inicializacao com a curva de easing e a correcao de
+ * gama.
+ *
+ * O CC guarda os niveis dos dois canais da fatia (A nos 16 bits baixos, B
+ * nos altos) e escritas de 16 bits sao replicadas nas duas metades pelo
+ * barramento; por isso cada entrada da tabela e uma palavra com os dois
+ * niveis, e as curvas de A e B sao geradas separadamente na mesma tabela.
+ * Um canal de DMA por fatia: as 8 fatias (16 saidas) usam 8 canais e
+ * nenhuma IRQ por passo.
+ *
+ * Cada entrada dura um periodo do PWM (ex.: wrap 65535 e clkdiv 4 dao
+ * ~477 passos por segundo). No modo em laco, a tabela e lida num anel:
+ * seu tamanho deve ser potencia de 2 e ela deve estar alinhada a ele
+ * (use FADE_PWM_TABELA).
+ */
+
+/**
+ * Expoente da correcao de gama aplicada ao brilho
+ */
+#ifndef FADE_PWM_GAMA
+#define FADE_PWM_GAMA 2.2f
+#endif
+
+/**
+ * Declara uma tabela de `passos` entradas (potencia de 2, ate 8192) alinhada para o anel
+ */
+#define FADE_PWM_TABELA(nome, passos) \
+    uint32_t nome[passos] __attribute__((aligned((passos) * sizeof(uint32_t))))
+
+/**
+ * Curva de easing: leva o progresso t (0 a 1) ao brilho relativo (0 a 1)
+ */
+typedef float (*fade_pwm_curva_t)(float t);
+
+float fade_pwm_linear(float t);
+float fade_pwm_quadratica(float t);
+float fade_pwm_suave(float t);   // smoothstep: acelera e desacelera
+float fade_pwm_seno(float t);    // meio periodo de seno: sobe e desce
+
+/**
+ * Estado de uma fatia. Os campos sao internos.
+ */
+typedef struct {
+    uint fatia;
+    uint canal;
+    uint32_t *tabela;
+    uint32_t passos;
+    bool em_laco;
+} fade_pwm_t;
+
+/**
+ * Prepara a fatia ja configurada (pwm_init) e reserva um canal de DMA
+ * @param fade Estado a ser inicializado (deve permanecer valido)
+ * @param fatia Fatia de PWM
+ * @param tabela Tabela de `passos` palavras (FADE_PWM_TABELA para o modo em laco)
+ * @param passos Numero de entradas
+ */
+void fade_pwm_init(fade_pwm_t *fade, uint fatia, uint32_t *tabela, uint32_t passos);
+
+/**
+ * Gera a curva de um canal da fatia na tabela, com correcao de gama
+ * e escala para o wrap atual da fatia. Nao deve ser chamada com o fade ativo.
+ * @param canal PWM_CHAN_A ou PWM_CHAN_B
+ * @param curva Easing aplicado entre `de` e `ate`
+ * @param de Brilho inicial (0 a 1)
+ * @param ate Brilho final (0 a 1)
+ * @param vai_e_volta Se verdadeiro, a primeira metade vai de `de` a `ate`
+ *                    e a segunda volta
+ */
+void fade_pwm_curva(fade_pwm_t *fade, enum pwm_chan canal, fade_pwm_curva_t curva,
+                    float de, float ate, bool vai_e_volta);
+
+/**
+ * Inicia a animacao
+ * @param em_laco false toca a tabela uma vez e mantem o ultimo nivel;
+ *                true repete indefinidamente
+ * @return false se o laco for pedido com uma tabela que nao serve de anel
+ */
+bool fade_pwm_iniciar(fade_pwm_t *fade, bool em_laco);
+
+/**
+ * Interrompe a animacao no nivel atual
+ */
+void fade_pwm_parar(fade_pwm_t *fade);
+
+/**
+ * Indica se a animacao esta em andamento
+ */
+bool fade_pwm_ativo(const fade_pwm_t *fade);
+
+#endif
@@ -0,0 +1,109 @@
+#include "fluxo_dma.h"
+#include "hardware/irq.h"
+#include "pico/stdlib.h"
+
+/**
+ * Fluxos registrados no handler de DMA_IRQ_0, pelos dois canais
+ */
+static fluxo_dma_t *instancias[NUM_DMA_CHANNELS];
+static bool handler_instalado = false;
+
+/**
+ * A metade deste canal ja voltou para o DMA: o encadeamento o reiniciou
+ * (a outra metade acabou) ou a outra metade ja parou de tocar
+ */
+static inline bool metade_reiniciada(const fluxo_dma_t *fluxo, uint metade) {
+    return dma_channel_is_busy(fluxo->canais[metade]) ||
+           !dma_channel_is_busy(fluxo->canais[metade ^ 1u]);
+}
+
+/**
+ * Fim de uma metade: o outro canal ja esta tocando; preenche esta
+ */
+static void concluir_metade(fluxo_dma_t *fluxo, uint metade) {
+    fluxo->blocos++;
+
+    // Confere antes (IRQ atendida tarde) e depois do produtor (produtor
+    // lento): nos dois casos o DMA leu esta metade enquanto ela era escrita
+    bool atrasado = metade_reiniciada(fluxo, metade);
+    fluxo->produtor(fluxo->buffers[metade], fluxo->palavras, fluxo->contexto);
+    if (atrasado || metade_reiniciada(fluxo, metade)) {
+        fluxo->underruns++;
+    }
+}
+
+static void irq_fluxo_dma(void) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        fluxo_dma_t *fluxo = instancias[i];
+        if (fluxo && dma_channel_get_irq0_status(i)) {
+            dma_channel_acknowledge_irq0(i);
+            concluir_metade(fluxo, i == fluxo->canais[0] ? 0 : 1);
+        }
+    }
+}
+
+void fluxo_dma_init(fluxo_dma_t *fluxo, volatile void *destino, uint dreq, uint32_t *buffer,
+                    uint bits, fluxo_dma_produtor_t produtor, void *contexto) {
+    fluxo->palavras = (1u << bits) / sizeof(uint32_t);
+    fluxo->buffers[0] = buffer;
+    fluxo->buffers[1] = buffer + fluxo->palavras;
+    fluxo->produtor = produtor;
+    fluxo->contexto = contexto;
+    fluxo->blocos = 0;
+    fluxo->underruns = 0;
+
+    for (uint metade = 0; metade < 2; metade++) {
+        fluxo->canais[metade] = (uint) dma_claim_unused_channel(true);
+        produtor(fluxo->buffers[metade], fluxo->palavras, contexto);
+    }
+
+    // Cada canal le a sua metade num anel e encadeia no outro ao terminar
+    for (uint metade = 0; metade < 2; metade++) {
+        dma_channel_config c = dma_channel_get_default_config(fluxo->canais[metade]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_ring(&c, false, bits);
+        channel_config_set_dreq(&c, dreq);
+        channel_config_set_chain_to(&c, fluxo->canais[metade ^ 1u]);
+        dma_channel_configure(fluxo->canais[metade], &c, destino, fluxo->buffers[metade],
+                              fluxo->palavras, false);
+
+        instancias[fluxo->canais[metade]] = fluxo;
+        dma_channel_set_irq0_enabled(fluxo->canais[metade], true);
+    }
+
+    if (!handler_instalado) {
+        irq_add_shared_handler(DMA_IRQ_0, irq_fluxo_dma, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        handler_instalado = true;
+    }
+
+    dma_channel_start(fluxo->canais[0]);
+}
+
+void fluxo_dma_parar(fluxo_dma_t *fluxo) {
+    uint32_t mascara = 0;
+
+    // Sem IRQ durante o abort (errata RP2040-E13); encadear um canal nele
+    // mesmo desliga o encadeamento, para que um nao reinicie o outro
+    for (uint metade = 0; metade < 2; metade++) {
+        uint canal = fluxo->canais[metade];
+        dma_channel_set_irq0_enabled(canal, false);
+        hw_write_masked(&dma_hw->ch[canal].al1_ctrl, canal << DMA_CH0_CTRL_TRIG_CHAIN_TO_LSB,
+                        DMA_CH0_CTRL_TRIG_CHAIN_TO_BITS);
+        mascara |= 1u << canal;
+    }
+
+    dma_hw->abort = mascara;
+    while (dma_hw->abort & mascara) {
+        tight_loop_contents();
+    }
+
+    for (uint metade = 0; metade < 2; metade++) {
+        uint canal = fluxo->canais[metade];
+        dma_channel_acknowledge_irq0(canal);
+        instancias[canal] = NULL;
+        dma_channel_unclaim(canal);
+    }
+}
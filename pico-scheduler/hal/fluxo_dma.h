@@ -0,0 +1,87 @@
+#ifndef FLUXO_DMA_H
+#define FLUXO_DMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/dma.h"
+
+/**
+ * Saida continua (ping-pong) por DMA para um periferico, como o FIFO TX de
+ * uma maquina de estado do PIO.
+ *
+ * Dois canais encadeados um no outro leem, cada um, metade de um buffer
+ * duplo: quando um termina, o outro ja comeca pelo hardware, sem esperar a
+ * IRQ. Cada canal usa um anel de leitura do tamanho da sua metade, entao o
+ * endereco de leitura volta sozinho ao inicio e a CPU nao precisa
+ * reprograma-lo. Na IRQ de fim de cada metade (DMA_IRQ_0, handler
+ * compartilhado), o produtor preenche a metade que acabou de tocar enquanto
+ * a outra esta no DMA.
+ *
+ * Se a IRQ for atendida tarde ou o produtor nao terminar antes da outra
+ * metade acabar, o encadeamento reinicia esta metade enquanto ela ainda
+ * esta sendo escrita: o DMA le uma mistura de dados antigos e novos (sem
+ * ler fora do buffer) e o produtor continua escrevendo na memoria que o DMA
+ * esta lendo. Cada ocorrencia e contada como underrun; a saida daquela
+ * metade deve ser considerada corrompida.
+ */
+
+/**
+ * Preenche uma metade do buffer duplo. Executa na IRQ de DMA do core que
+ * chamou fluxo_dma_init (e duas vezes dentro dela, antes do inicio).
+ * @param buffer Metade a preencher
+ * @param palavras Tamanho da metade, em palavras de 32 bits
+ */
+typedef void (*fluxo_dma_produtor_t)(uint32_t *buffer, uint32_t palavras, void *contexto);
+
+/**
+ * Estado de um fluxo. Os campos sao internos.
+ */
+typedef struct {
+    uint canais[2];
+    uint32_t *buffers[2];
+    uint32_t palavras;
+
+    fluxo_dma_produtor_t produtor;
+    void *contexto;
+
+    volatile uint32_t blocos;
+    volatile uint32_t underruns;
+} fluxo_dma_t;
+
+/**
+ * Reserva dois canais, preenche as duas metades e inicia o fluxo
+ *
+ * @param fluxo Estado a ser inicializado (deve permanecer valido)
+ * @param destino Registrador de dados do periferico (ex.: &pio->txf[sm])
+ * @param dreq DREQ do periferico (ex.: pio_get_dreq(pio, sm, true))
+ * @param buffer Buffer duplo de 2 * 2^bits bytes, alinhado a 2^bits
+ *               (ex.: uint32_t buffer[2][256] __attribute__((aligned(1024)))
+ *               para bits = 10)
+ * @param bits Log2 do tamanho de cada metade, em bytes (2 a 15)
+ * @param produtor Preenche cada metade
+ * @param contexto Repassado ao produtor
+ */
+void fluxo_dma_init(fluxo_dma_t *fluxo, volatile void *destino, uint dreq, uint32_t *buffer,
+                    uint bits, fluxo_dma_produtor_t produtor, void *contexto);
+
+/**
+ * Interrompe o fluxo e libera os canais
+ */
+void fluxo_dma_parar(fluxo_dma_t *fluxo);
+
+/**
+ * Metades tocadas desde o inicio
+ */
+static inline uint32_t fluxo_dma_blocos(const fluxo_dma_t *fluxo) {
+    return fluxo->blocos;
+}
+
+/**
+ * Metades que voltaram ao DMA antes de o produtor terminar de preenche-las
+ * (saida misturada naquela metade)
+ */
+static inline uint32_t fluxo_dma_underruns(const fluxo_dma_t *fluxo) {
+    return fluxo->underruns;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Gera crc32_tabela.h: tabelas do CRC-32 (IEEE 802.3, refletido) para os
+caminhos por tabela e slice-by-4/8 de crc32.c.
+
+Uso: python3 gerar_crc32_tabela.py > crc32_tabela.h
+"""
+
+POLINOMIO = 0xEDB88320
+FATIAS = 8
+
+
+def gerar():
+    tabelas = [[0] * 256 for _ in range(FATIAS)]
+
+    for i in range(256):
+        crc = i
+        for _ in range(8):
+            crc = (crc >> 1) ^ (POLINOMIO if crc & 1 else 0)
+        tabelas[0][i] = crc
+
+    # Fatia k: efeito de um byte seguido de k bytes zero
+    for k in range(1, FATIAS):
+        for i in range(256):
+            anterior = tabelas[k - 1][i]
+            tabelas[k][i] = (anterior >> 8) ^ tabelas[0][anterior & 0xFF]
+
+    return tabelas
+
+
+def main():
+    tabelas = gerar()
+
+    print("// Gerado por gerar_crc32_tabela.py; nao edite a mao.")
+    print("#ifndef CRC32_TABELA_H")
+    print("#define CRC32_TABELA_H")
+    print()
+    print("#include <stdint.h>")
+    print()
+    print("static CRC32_TABELA_CONST uint32_t crc32_tabela[%d][256] = {" % FATIAS)
+    for tabela in tabelas:
+        print("    {")
+        for inicio in range(0, 256, 6):
+            valores = ", ".join("0x%08x" % v for v in tabela[inicio:inicio + 6])
+            print("        %s," % valores)
+        print("    },")
+    print("};")
+    print()
+    print("#endif")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,60 @@
+#include "medida_fixa.h"
+
+#define MEDIDA_FIXA_MAX_DESLOCAMENTO 63u
+
+bool medida_fixa_escala_init(medida_fixa_escala_t *escala, uint64_t numerador,
+                             uint64_t denominador) {
+    const uint64_t limite = UINT64_MAX >> 1;
+
+    if (denominador == 0 || denominador > limite || numerador > limite) {
+        return false;
+    }
+
+    uint64_t fator = numerador / denominador;
+    uint64_t resto = numerador % denominador;
+    uint32_t deslocamento = 0;
+
+    if (fator > UINT32_MAX) {
+        return false;
+    }
+
+    // Divisao longa, um bit de fracao por vez, ate o fator ocupar 32 bits;
+    // resto < denominador < 2^63, entao o deslocamento do resto nao estoura
+    while (fator < (1ull << 31) && deslocamento < MEDIDA_FIXA_MAX_DESLOCAMENTO) {
+        resto <<= 1;
+        fator <<= 1;
+        if (resto >= denominador) {
+            resto -= denominador;
+            fator |= 1u;
+        }
+        deslocamento++;
+    }
+
+    // Arredonda o ultimo bit; se passar de 32 bits, perde um bit de fracao
+    if (resto >= denominador - resto) {
+        fator++;
+        if (fator > UINT32_MAX) {
+            if (deslocamento == 0) {
+                return false;
+            }
+            fator >>= 1;
+            deslocamento--;
+        }
+    }
+
+    escala->fator = (uint32_t) fator;
+    escala->deslocamento = deslocamento;
+    return true;
+}
+
+bool medida_fixa_ciclo_init(medida_fixa_escala_t *escala, uint32_t clk_hz, uint32_t divisor,
+                            uint32_t janela_us) {
+    // ppm = contagem * divisor * 10^12 / (clk_hz * janela_us)
+    return medida_fixa_escala_init(escala, (uint64_t) divisor * 1000000000000ull,
+                                   (uint64_t) clk_hz * janela_us);
+}
+
+bool medida_fixa_frequencia_init(medida_fixa_escala_t *escala, uint32_t janela_us) {
+    // mHz = bordas * 10^9 / janela_us
+    return medida_fixa_escala_init(escala, 1000000000ull, janela_us);
+}
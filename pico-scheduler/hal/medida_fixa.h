@@ -0,0 +1,87 @@
+#ifndef MEDIDA_FIXA_H
+#define MEDIDA_FIXA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Conversoes de medidas em ponto fixo, sem float: o M0+ nao tem FPU e
+ * cada operacao em float vira uma chamada de soft-float.
+ *
+ * A razao de uma conversao (por exemplo, contagens por ppm para o relogio
+ * atual) e calculada uma vez, em medida_fixa_escala_init, como um fator de
+ * 32 bits com deslocamento; depois, cada conversao e uma multiplicacao
+ * 32 x 32 -> 64 e dois deslocamentos. Os resultados saem em unidades
+ * inteiras pequenas (ppm, mHz, micrometros). Sem dependencias do SDK,
+ * para poder ser conferido no host (host/bench/bench_medida.c).
+ */
+
+/**
+ * Velocidade do som usada por medida_fixa_distancia_um, em m/s (343 m/s
+ * a 20 graus; o mesmo que 0,0343 cm/us)
+ */
+#ifndef MEDIDA_FIXA_SOM_M_S
+#define MEDIDA_FIXA_SOM_M_S 343u
+#endif
+
+/**
+ * Razao numerador / denominador pre-calculada: valor * fator / 2^deslocamento.
+ * O fator tem 32 bits significativos sempre que a razao permite, entao o
+ * erro relativo fica abaixo de 2^-31, mais meia unidade do arredondamento.
+ */
+typedef struct {
+    uint32_t fator;
+    uint32_t deslocamento;
+} medida_fixa_escala_t;
+
+/**
+ * Pre-calcula a razao numerador / denominador. Feita fora do caminho
+ * rapido, pois usa divisao de 64 bits.
+ * @param numerador Ate 2^63 - 1
+ * @param denominador Entre 1 e 2^63 - 1
+ * @return false se o denominador for 0 ou a razao nao couber em 32 bits
+ */
+bool medida_fixa_escala_init(medida_fixa_escala_t *escala, uint64_t numerador,
+                             uint64_t denominador);
+
+/**
+ * Aplica a escala com arredondamento, saturando em UINT32_MAX
+ */
+static inline uint32_t medida_fixa_aplicar(const medida_fixa_escala_t *escala, uint32_t valor) {
+    uint64_t produto = (uint64_t) valor * escala->fator;
+    if (escala->deslocamento) {
+        // Desloca um bit a menos e arredonda com o ultimo: nao estoura 64 bits
+        produto = ((produto >> (escala->deslocamento - 1)) + 1u) >> 1;
+    }
+    return produto > UINT32_MAX ? UINT32_MAX : (uint32_t) produto;
+}
+
+/**
+ * Escala de contagens de PWM_DIV_B_HIGH para ciclo de trabalho em ppm:
+ * o contador avanca uma vez a cada `divisor` ciclos em nivel alto, e o
+ * maximo numa janela e clk_hz * janela_us / (divisor * 10^6)
+ * @param clk_hz Relogio do sistema (clock_get_hz(clk_sys))
+ * @param divisor Divisor inteiro do contador de PWM
+ * @param janela_us Duracao da janela de contagem
+ */
+bool medida_fixa_ciclo_init(medida_fixa_escala_t *escala, uint32_t clk_hz, uint32_t divisor,
+                            uint32_t janela_us);
+
+/**
+ * Escala de bordas contadas numa janela para frequencia em mHz
+ * @param janela_us Duracao da janela de contagem
+ */
+bool medida_fixa_frequencia_init(medida_fixa_escala_t *escala, uint32_t janela_us);
+
+/**
+ * Distancia ate o obstaculo, em micrometros, a partir do tempo de ida e
+ * volta do eco. Valida ate cerca de 12 s de eco, bem acima do alcance de
+ * qualquer sensor.
+ * @param eco_us Duracao do pulso de eco em microssegundos
+ */
+static inline uint32_t medida_fixa_distancia_um(uint32_t eco_us) {
+    // O som anda MEDIDA_FIXA_SOM_M_S um/us; metade do caminho, arredondado
+    return (eco_us * MEDIDA_FIXA_SOM_M_S + 1u) >> 1;
+}
+
+#endif
@@ -0,0 +1,141 @@
+#include "melodia.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+#include "hardware/pwm.h"
+
+/**
+ * Maior divisor em 1/16 (255 + 15/16)
+ */
+#define DIVISOR_MAX ((255u << 4) | 0xfu)
+
+/**
+ * Fatias com buzzer, uma melodia por fatia
+ */
+static uint32_t fatias_em_uso = 0;
+
+bool melodia_preparar(const nota_t *notas, size_t num_notas, nota_pwm_t *destino) {
+    // Relogio em 1/16 de Hz, para o divisor fracionario
+    uint64_t relogio = (uint64_t) clock_get_hz(clk_sys) << 4;
+
+    for (size_t i = 0; i < num_notas; i++) {
+        uint32_t frequencia = notas[i].frequencia_hz;
+        nota_pwm_t *n = &destino[i];
+
+        if (notas[i].duracao_ms == 0) {
+            return false;
+        }
+        n->duracao_us = notas[i].duracao_ms * 1000u;
+
+        if (frequencia == 0) {
+            n->divisor = 1u << 4;
+            n->topo = 0xffffu;
+            n->nivel = 0;
+            continue;
+        }
+
+        // Menor divisor com periodo de ate 65536 contagens: maior resolucao
+        uint64_t contagens = relogio / frequencia; // divisor * (TOP + 1), em 1/16
+        uint64_t divisor = (contagens + 0xffffu) >> 16;
+        if (divisor < (1u << 4)) {
+            divisor = 1u << 4;
+        }
+        if (divisor > DIVISOR_MAX) {
+            return false;
+        }
+
+        uint32_t periodo = (uint32_t) ((contagens + divisor / 2) / divisor);
+        n->divisor = (uint32_t) divisor;
+        n->topo = (uint16_t) (periodo - 1u);
+        n->nivel = (uint16_t) (periodo / 2u);
+    }
+    return true;
+}
+
+/**
+ * Copia os registradores da nota atual para a fatia
+ */
+static void aplicar(const melodia_t *m) {
+    const nota_pwm_t *n = &m->notas[m->posicao];
+
+    pwm_hw->slice[m->fatia].div = n->divisor;
+    pwm_set_wrap(m->fatia, n->topo);
+    pwm_set_chan_level(m->fatia, m->canal, n->nivel);
+}
+
+static void silenciar(melodia_t *m) {
+    pwm_set_chan_level(m->fatia, m->canal, 0);
+    m->tocando = false;
+}
+
+/**
+ * Fim de uma nota: passa para a proxima e se reagenda pela duracao dela
+ */
+static int64_t proxima_nota(alarm_id_t id, void *dados) {
+    (void) id;
+    melodia_t *m = dados;
+
+    if (++m->posicao == m->num_notas) {
+        if (!m->em_laco) {
+            m->alarme = 0;
+            silenciar(m);
+            return 0;
+        }
+        m->posicao = 0;
+    }
+
+    aplicar(m);
+
+    // Negativo: conta a partir do prazo anterior, sem acumular o atraso da
+    // IRQ e deste callback (positivo contaria a partir do retorno)
+    return -(int64_t) m->notas[m->posicao].duracao_us;
+}
+
+bool melodia_init(melodia_t *m, uint pino) {
+    uint fatia = pwm_gpio_to_slice_num(pino);
+    if (fatias_em_uso & (1u << fatia)) {
+        return false;
+    }
+    fatias_em_uso |= 1u << fatia;
+
+    *m = (melodia_t) {
+        .pino = pino,
+        .fatia = fatia,
+        .canal = pwm_gpio_to_channel(pino),
+    };
+
+    pwm_config cfg = pwm_get_default_config();
+    pwm_init(fatia, &cfg, true);
+    pwm_set_chan_level(fatia, m->canal, 0);
+    gpio_set_function(pino, GPIO_FUNC_PWM);
+    return true;
+}
+
+bool melodia_tocar(melodia_t *m, const nota_pwm_t *notas, size_t num_notas, bool em_laco) {
+    melodia_parar(m);
+    if (num_notas == 0) {
+        return true;
+    }
+
+    m->notas = notas;
+    m->num_notas = num_notas;
+    m->posicao = 0;
+    m->em_laco = em_laco;
+    m->tocando = true;
+    aplicar(m);
+
+    m->alarme = add_alarm_in_us(notas[0].duracao_us, proxima_nota, m, true);
+    if (m->alarme < 0) {
+        m->alarme = 0;
+        silenciar(m);
+        return false;
+    }
+    return true;
+}
+
+void melodia_parar(melodia_t *m) {
+    if (m->alarme > 0) {
+        cancel_alarm(m->alarme);
+        m->alarme = 0;
+    }
+    silenciar(m);
+}
@@ -0,0 +1,95 @@
+#ifndef MELODIA_H
+#define MELODIA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pico/time.h"
+
+/**
+ * Melodias em segundo plano num buzzer passivo, por PWM.
+ *
+ * A sequencia de notas (frequencia, duracao) e convertida uma vez, com o
+ * relogio atual (clock_get_hz), nos valores dos registradores de PWM:
+ * divisor fracionario 8.4, TOP e nivel de 50%. Durante a musica, um alarme
+ * por buzzer apenas copia esses valores para a fatia a cada troca de nota
+ * e se reagenda pela duracao da nota, contada a partir do prazo anterior
+ * (retorno negativo do callback, sem acumular o atraso de atendimento). O
+ * laco principal fica livre e varios buzzers, em fatias diferentes, tocam
+ * ao mesmo tempo.
+ *
+ * Se o relogio do sistema mudar, prepare as notas de novo.
+ */
+
+/**
+ * Uma nota da partitura; frequencia 0 e uma pausa
+ */
+typedef struct {
+    uint16_t frequencia_hz;
+    uint16_t duracao_ms;
+} nota_t;
+
+/**
+ * Uma nota ja convertida para a fatia de PWM
+ */
+typedef struct {
+    uint32_t divisor;    // registrador DIV: parte inteira << 4 | fracao em 1/16
+    uint16_t topo;       // registrador TOP
+    uint16_t nivel;      // nivel do canal (0 na pausa)
+    uint32_t duracao_us;
+} nota_pwm_t;
+
+/**
+ * Estado de um buzzer
+ */
+typedef struct {
+    uint pino;
+    uint fatia;
+    uint canal;
+    const nota_pwm_t *notas;
+    size_t num_notas;
+    size_t posicao;
+    bool em_laco;
+    alarm_id_t alarme;
+    volatile bool tocando;
+} melodia_t;
+
+/**
+ * Converte uma partitura com o relogio atual
+ * @param notas Partitura
+ * @param num_notas Numero de notas
+ * @param destino Notas convertidas (num_notas posicoes)
+ * @return false se alguma frequencia nao couber no PWM (abaixo de ~8 Hz
+ *         a 125 MHz) ou alguma duracao for 0
+ */
+bool melodia_preparar(const nota_t *notas, size_t num_notas, nota_pwm_t *destino);
+
+/**
+ * Configura o pino do buzzer, em silencio
+ * @param m Estado a ser inicializado (deve permanecer valido)
+ * @param pino Pino do buzzer
+ * @return false se a fatia de PWM do pino ja tiver outro buzzer
+ */
+bool melodia_init(melodia_t *m, uint pino);
+
+/**
+ * Comeca a tocar; interrompe a melodia anterior do mesmo buzzer
+ * @param notas Notas convertidas (devem permanecer validas durante a musica)
+ * @param em_laco Recomeca do inicio ao terminar, ate melodia_parar
+ * @return false se nao houver alarme livre
+ */
+bool melodia_tocar(melodia_t *m, const nota_pwm_t *notas, size_t num_notas, bool em_laco);
+
+/**
+ * Interrompe a melodia e silencia o buzzer
+ */
+void melodia_parar(melodia_t *m);
+
+/**
+ * A melodia ainda esta tocando?
+ */
+static inline bool melodia_tocando(const melodia_t *m) {
+    return m->tocando;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#include "padrao_pwm.h"
+
+bool padrao_pwm_init(padrao_pwm_t *tabela, uint32_t *buffer, uint32_t niveis) {
+    uint32_t palavras = PADRAO_PWM_PALAVRAS(niveis);
+
+    // Um bit por nivel, em palavras inteiras; o anel de leitura do DMA exige
+    // padroes de tamanho potencia de 2 (ate 2^15 bytes)
+    if (niveis != palavras * 32u || palavras == 0 || (palavras & (palavras - 1)) != 0 ||
+        palavras > (1u << 13)) {
+        return false;
+    }
+
+    for (uint32_t nivel = 0; nivel <= niveis; nivel++) {
+        uint32_t *padrao = buffer + nivel * palavras;
+        uint32_t restantes = nivel;
+
+        for (uint32_t i = 0; i < palavras; i++) {
+            padrao[i] = restantes >= 32 ? 0xffffffffu : ~(~0u << restantes);
+            restantes -= restantes >= 32 ? 32 : restantes;
+        }
+    }
+
+    tabela->padroes = buffer;
+    tabela->niveis = niveis;
+    tabela->palavras = palavras;
+    return true;
+}
+
+uint32_t padrao_pwm_bits_anel(const padrao_pwm_t *tabela) {
+    uint32_t bits = 2;
+    while ((1u << bits) < tabela->palavras * sizeof(uint32_t)) {
+        bits++;
+    }
+    return bits;
+}
@@ -0,0 +1,107 @@
+#ifndef PADRAO_PWM_H
+#define PADRAO_PWM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Padroes de bits para PWM por serializacao (ex.: o pio_serialiser do
+ * exemplo dma/channel_irq), gerados uma vez na inicializacao.
+ *
+ * O nivel `n` de uma tabela com N niveis e um padrao de N bits com `n` bits
+ * em 1, guardado em N / 32 palavras. Ha N + 1 padroes (de apagado a
+ * totalmente aceso), cada um alinhado ao proprio tamanho: um canal de DMA
+ * com anel de leitura de padrao_pwm_bits_anel() bytes repete um padrao
+ * indefinidamente, e trocar de nivel e so trocar o ponteiro.
+ *
+ * O modulador sigma-delta obtem niveis intermediarios (2^PADRAO_PWM_BITS_FRACAO
+ * passos entre dois niveis) alternando entre os dois padroes vizinhos a
+ * cada periodo.
+ */
+
+/**
+ * Bits de fracao do nivel no modulador sigma-delta
+ */
+#ifndef PADRAO_PWM_BITS_FRACAO
+#define PADRAO_PWM_BITS_FRACAO 8
+#endif
+
+/**
+ * Palavras por padrao e tamanho do buffer (em palavras) para `niveis`
+ */
+#define PADRAO_PWM_PALAVRAS(niveis) ((niveis) / 32u)
+#define PADRAO_PWM_TAMANHO(niveis) (((niveis) + 1u) * PADRAO_PWM_PALAVRAS(niveis))
+
+/**
+ * Declara o buffer de uma tabela com o alinhamento exigido pelo anel
+ */
+#define PADRAO_PWM_BUFFER(nome, niveis) \
+    uint32_t nome[PADRAO_PWM_TAMANHO(niveis)] __attribute__((aligned((niveis) / 8u)))
+
+typedef struct {
+    const uint32_t *padroes;
+    uint32_t niveis;
+    uint32_t palavras;
+} padrao_pwm_t;
+
+/**
+ * Gera os padroes de todos os niveis
+ * @param tabela Tabela a ser inicializada
+ * @param buffer Buffer declarado com PADRAO_PWM_BUFFER(buffer, niveis)
+ * @param niveis Resolucao: 32, 64, 128, 256, ... (32 vezes potencia de 2, ate 2^18)
+ * @return false se `niveis` nao for suportado
+ */
+bool padrao_pwm_init(padrao_pwm_t *tabela, uint32_t *buffer, uint32_t niveis);
+
+/**
+ * Padrao de um nivel (saturado em tabela->niveis)
+ */
+static inline const uint32_t *padrao_pwm_nivel(const padrao_pwm_t *tabela, uint32_t nivel) {
+    if (nivel > tabela->niveis) {
+        nivel = tabela->niveis;
+    }
+    return tabela->padroes + nivel * tabela->palavras;
+}
+
+/**
+ * Log2 do tamanho de um padrao em bytes, para channel_config_set_ring
+ */
+uint32_t padrao_pwm_bits_anel(const padrao_pwm_t *tabela);
+
+/**
+ * Modulador sigma-delta de primeira ordem sobre uma tabela
+ */
+typedef struct {
+    const padrao_pwm_t *tabela;
+    uint32_t alvo;       // nivel com PADRAO_PWM_BITS_FRACAO bits de fracao
+    uint32_t acumulador; // erro acumulado (fracao)
+} padrao_pwm_sigma_delta_t;
+
+static inline void padrao_pwm_sigma_delta_init(padrao_pwm_sigma_delta_t *sd,
+                                               const padrao_pwm_t *tabela, uint32_t alvo) {
+    sd->tabela = tabela;
+    sd->alvo = alvo;
+    sd->acumulador = 0;
+}
+
+/**
+ * Muda o nivel desejado, em unidades de 2^-PADRAO_PWM_BITS_FRACAO nivel
+ */
+static inline void padrao_pwm_sigma_delta_alvo(padrao_pwm_sigma_delta_t *sd, uint32_t alvo) {
+    sd->alvo = alvo;
+}
+
+/**
+ * Padrao do proximo periodo: o nivel inteiro ou o seguinte, de modo que a
+ * media acompanhe o alvo
+ */
+static inline const uint32_t *padrao_pwm_sigma_delta_proximo(padrao_pwm_sigma_delta_t *sd) {
+    const uint32_t mascara = (1u << PADRAO_PWM_BITS_FRACAO) - 1u;
+    uint32_t soma = sd->acumulador + (sd->alvo & mascara);
+
+    sd->acumulador = soma & mascara;
+    return padrao_pwm_nivel(sd->tabela,
+                            (sd->alvo >> PADRAO_PWM_BITS_FRACAO) + (soma >> PADRAO_PWM_BITS_FRACAO));
+}
+
+#endif
@@ -0,0 +1,35 @@
+#include "planos_bits.h"
+
+void planos_bits_transpor(const uint16_t ciclos[PLANOS_BITS_MAX], uint16_t planos[PLANOS_BITS_MAX]) {
+    // Palavras de 32 bits evitam extensoes de 16 bits a cada operacao no M0+
+    uint32_t a[PLANOS_BITS_MAX];
+    for (uint32_t i = 0; i < PLANOS_BITS_MAX; i++) {
+        a[i] = ciclos[i];
+    }
+
+    // Troca o quadrante (linhas k, bits k + j) com (linhas k + j, bits k) em
+    // blocos de j = 8, 4, 2 e 1; m seleciona a metade baixa de cada bloco
+    uint32_t m = 0x00ffu;
+    for (uint32_t j = 8; j != 0; j >>= 1, m ^= m << j) {
+        for (uint32_t k = 0; k < PLANOS_BITS_MAX; k = ((k | j) + 1) & ~j) {
+            uint32_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+
+    for (uint32_t i = 0; i < PLANOS_BITS_MAX; i++) {
+        planos[i] = (uint16_t) a[i];
+    }
+}
+
+void planos_bits_transpor_referencia(const uint16_t ciclos[PLANOS_BITS_MAX],
+                                     uint16_t planos[PLANOS_BITS_MAX]) {
+    for (uint32_t b = 0; b < PLANOS_BITS_MAX; b++) {
+        uint16_t plano = 0;
+        for (uint32_t c = 0; c < PLANOS_BITS_MAX; c++) {
+            plano |= (uint16_t) (((ciclos[c] >> b) & 1u) << c);
+        }
+        planos[b] = plano;
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef PLANOS_BITS_H
+#define PLANOS_BITS_H
+
+#include <stdint.h>
+
+/**
+ * Conversao de ciclos de trabalho por canal em planos de bits, para PWM
+ * por modulacao de codigo binario (BCM) em varios pinos ao mesmo tempo.
+ *
+ * O plano `b` tem no bit `c` o bit `b` do ciclo do canal `c`: e a
+ * transposta da matriz de bits 16 x 16 formada pelos ciclos. Sem
+ * dependencias do SDK, para poder ser conferida no host
+ * (host/bench/bench_planos.c).
+ */
+
+#define PLANOS_BITS_MAX 16
+
+/**
+ * Transposicao rapida: quatro etapas de troca de blocos (8, 4, 2 e 1 bits)
+ * com mascaras, sem percorrer bit a bit
+ * @param ciclos Ciclo de cada canal (canais ausentes em 0)
+ * @param planos Destino: planos[b] com o bit b de cada canal
+ */
+void planos_bits_transpor(const uint16_t ciclos[PLANOS_BITS_MAX], uint16_t planos[PLANOS_BITS_MAX]);
+
+/**
+ * Modelo de referencia, bit a bit, com o mesmo contrato
+ */
+void planos_bits_transpor_referencia(const uint16_t ciclos[PLANOS_BITS_MAX],
+                                     uint16_t planos[PLANOS_BITS_MAX]);
+
+#endif
@@ -0,0 +1,103 @@
+#include "pwm_paralelo.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "pwm_paralelo.pio.h"
+
+/**
+ * O quadro sempre tem PLANOS_BITS_MAX palavras, alinhado para o anel
+ */
+#define BITS_ANEL 6
+
+static uint32_t quadros[NUM_PIOS * NUM_PIO_STATE_MACHINES][PLANOS_BITS_MAX]
+    __attribute__((aligned(1u << BITS_ANEL)));
+
+/**
+ * Instancias registradas no handler de DMA_IRQ_0, pelo canal
+ */
+static pwm_paralelo_t *instancias[NUM_DMA_CHANNELS];
+static bool handler_instalado = false;
+
+/**
+ * O canal para depois de 2^32 - 1 palavras: reinicia na mesma posicao do anel
+ */
+static void irq_pwm_paralelo(void) {
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++) {
+        if (instancias[i] && dma_channel_get_irq0_status(i)) {
+            dma_channel_acknowledge_irq0(i);
+            dma_channel_set_trans_count(i, UINT32_MAX, true);
+        }
+    }
+}
+
+/**
+ * Palavra do FIFO: plano nos 16 bits baixos e duracao - 3 nos altos
+ */
+static inline uint32_t palavra_plano(const pwm_paralelo_t *pwm, uint32_t b, uint16_t plano) {
+    if (b >= pwm->bits) {
+        return 0;
+    }
+    return plano | (((pwm->ciclos_base << b) - 3u) << 16);
+}
+
+bool pwm_paralelo_init(pwm_paralelo_t *pwm, PIO pio, uint pino_base, uint num_canais, uint bits,
+                       uint32_t ciclos_base) {
+    if (num_canais == 0 || num_canais > PLANOS_BITS_MAX || bits == 0 || bits > PLANOS_BITS_MAX ||
+        ciclos_base < 3 || (ciclos_base << (bits - 1)) - 3u > 0xffffu) {
+        return false;
+    }
+
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0 || !pio_can_add_program(pio, &pwm_paralelo_program)) {
+        if (sm >= 0) {
+            pio_sm_unclaim(pio, (uint) sm);
+        }
+        return false;
+    }
+
+    pwm->pio = pio;
+    pwm->sm = (uint) sm;
+    pwm->num_canais = num_canais;
+    pwm->bits = bits;
+    pwm->ciclos_base = ciclos_base;
+    pwm->quadro = quadros[pio_get_index(pio) * NUM_PIO_STATE_MACHINES + pwm->sm];
+
+    static const uint16_t apagados[PLANOS_BITS_MAX] = { 0 };
+    pwm_paralelo_definir(pwm, apagados);
+
+    uint offset = pio_add_program(pio, &pwm_paralelo_program);
+    pwm_paralelo_program_init(pio, pwm->sm, offset, pino_base, num_canais);
+
+    // Le o quadro em anel, no ritmo do FIFO TX da maquina de estado
+    pwm->canal = (uint) dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(pwm->canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_ring(&c, false, BITS_ANEL);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, pwm->sm, true));
+
+    if (!handler_instalado) {
+        irq_add_shared_handler(DMA_IRQ_0, irq_pwm_paralelo, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        handler_instalado = true;
+    }
+    instancias[pwm->canal] = pwm;
+    dma_channel_set_irq0_enabled(pwm->canal, true);
+
+    dma_channel_configure(pwm->canal, &c, &pio->txf[pwm->sm], pwm->quadro, UINT32_MAX, true);
+    return true;
+}
+
+void pwm_paralelo_definir(pwm_paralelo_t *pwm, const uint16_t *ciclos) {
+    uint16_t entrada[PLANOS_BITS_MAX] = { 0 };
+    uint16_t planos[PLANOS_BITS_MAX];
+
+    for (uint i = 0; i < pwm->num_canais; i++) {
+        entrada[i] = ciclos[i];
+    }
+    planos_bits_transpor(entrada, planos);
+
+    for (uint32_t b = 0; b < PLANOS_BITS_MAX; b++) {
+        pwm->quadro[b] = palavra_plano(pwm, b, planos[b]);
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef PWM_PARALELO_H
+#define PWM_PARALELO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/pio.h"
+#include "planos_bits.h"
+
+/**
+ * PWM em ate 16 pinos consecutivos com uma maquina de estado do PIO.
+ *
+ * Usa modulacao de codigo binario: o quadro tem um plano de bits por bit
+ * de resolucao (planos_bits.h) e o plano `b` fica na saida por
+ * ciclos_base << b ciclos do PIO, em todos os pinos ao mesmo tempo
+ * (`out pins, 16`). Um canal de DMA repete o quadro com um anel de leitura
+ * e so precisa da CPU uma vez a cada 2^32 palavras (DMA_IRQ_0, handler
+ * compartilhado).
+ *
+ * O periodo e (2^bits - 1) * ciclos_base ciclos, mais 3 ciclos por plano
+ * nao usado do quadro de 16 palavras (saida apagada).
+ */
+
+typedef struct {
+    PIO pio;
+    uint sm;
+    uint canal;
+    uint num_canais;
+    uint bits;
+    uint32_t ciclos_base;
+    uint32_t *quadro;
+} pwm_paralelo_t;
+
+/**
+ * Carrega o programa, reserva uma maquina de estado e um canal de DMA e
+ * comeca com todos os canais apagados
+ * @param pwm Estado a ser inicializado (deve permanecer valido)
+ * @param pio PIO a usar
+ * @param pino_base Primeiro pino; os canais usam pino_base ... pino_base + num_canais - 1
+ * @param num_canais Numero de saidas (1 a 16)
+ * @param bits Resolucao do ciclo de trabalho (1 a 16)
+ * @param ciclos_base Duracao do plano menos significativo, em ciclos do
+ *                    sistema (3 ou mais; (ciclos_base << (bits - 1)) ate 65538)
+ * @return false se os parametros nao forem suportados
+ */
+bool pwm_paralelo_init(pwm_paralelo_t *pwm, PIO pio, uint pino_base, uint num_canais, uint bits,
+                       uint32_t ciclos_base);
+
+/**
+ * Muda os ciclos de trabalho de todos os canais
+ *
+ * Os planos sao escritos no quadro em uso: o periodo em andamento pode
+ * misturar planos antigos e novos, o que aparece no maximo como um periodo
+ * com brilho intermediario.
+ * @param ciclos Um valor por canal, de 0 a 2^bits - 1
+ */
+void pwm_paralelo_definir(pwm_paralelo_t *pwm, const uint16_t *ciclos);
+
+#endif
@@ -0,0 +1,163 @@
+#include "uart_rx_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+/**
+ * Tamanho de cada disparo do canal. Ao terminar (horas depois, mesmo a
+ * varios Mbaud), a IRQ de DMA dispara o canal de novo.
+ */
+#define TRANSFERENCIAS_POR_DISPARO 0xffffffffu
+
+/**
+ * UARTs registradas no handler de DMA
+ */
+static uart_rx_dma_t *instancias[NUM_UARTS];
+static bool handler_dma_instalado = false;
+
+/**
+ * Total de bytes escritos no anel (modulo 2^32). Chamada com a trava.
+ */
+static uint32_t escritos(const uart_rx_dma_t *rx) {
+    uint32_t restantes = dma_hw->ch[rx->canal].transfer_count;
+    return rx->base_escritos + (TRANSFERENCIAS_POR_DISPARO - restantes);
+}
+
+/**
+ * Timeout de recepcao: chama o callback quando chegaram dados desde a
+ * ultima verificacao e, nesta, nenhum byte novo
+ */
+static int64_t verificar_linha(alarm_id_t id, void *dados) {
+    (void) id;
+    uart_rx_dma_t *rx = dados;
+
+    uint32_t salvo = spin_lock_blocking(rx->trava);
+    uint32_t total = escritos(rx);
+    spin_unlock(rx->trava, salvo);
+
+    if (total != rx->ultimo_visto) {
+        rx->ultimo_visto = total;
+        rx->recebendo = true;
+    } else if (rx->recebendo) {
+        rx->recebendo = false;
+        rx->ao_receber(rx->contexto);
+    }
+
+    // Negativo: conta a partir do prazo anterior. Com a linha parada basta
+    // notar a chegada de dados; o intervalo fino so vale durante o quadro
+    uint32_t intervalo_us = rx->recebendo ? rx->timeout_us : MAX(rx->timeout_us, UART_RX_DMA_OCIOSO_US);
+    return -(int64_t) intervalo_us;
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_0: redispara o canal que esgotou a contagem
+ */
+static void irq_dma_rx(void) {
+    for (uint i = 0; i < NUM_UARTS; i++) {
+        uart_rx_dma_t *rx = instancias[i];
+        if (!rx || !dma_channel_get_irq0_status(rx->canal)) {
+            continue;
+        }
+
+        uint32_t salvo = spin_lock_blocking(rx->trava);
+        dma_channel_acknowledge_irq0(rx->canal);
+        rx->base_escritos += TRANSFERENCIAS_POR_DISPARO;
+        dma_channel_set_trans_count(rx->canal, TRANSFERENCIAS_POR_DISPARO, true);
+        spin_unlock(rx->trava, salvo);
+    }
+}
+
+void uart_rx_dma_init(uart_rx_dma_t *rx, uart_inst_t *uart, uint8_t *anel, uint bits,
+                      uint32_t timeout_us, uart_rx_dma_callback_t ao_receber, void *contexto) {
+    hard_assert(bits >= 1 && bits <= 15);
+    hard_assert(((uintptr_t) anel & ((1u << bits) - 1u)) == 0);
+
+    rx->uart = uart;
+    rx->anel = anel;
+    rx->mascara = (1u << bits) - 1u;
+    rx->base_escritos = 0;
+    rx->consumidos = 0;
+    rx->perdidos = 0;
+    rx->timeout_us = timeout_us;
+    rx->ultimo_visto = 0;
+    rx->recebendo = false;
+    rx->ao_receber = ao_receber;
+    rx->contexto = contexto;
+    rx->trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+    rx->canal = (uint) dma_claim_unused_channel(true);
+
+    uart_set_fifo_enabled(uart, true);
+
+    // Le sempre o registrador de dados; a escrita da a volta a cada 2^bits bytes
+    dma_channel_config c = dma_channel_get_default_config(rx->canal);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, bits);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, false));
+
+    instancias[uart_get_index(uart)] = rx;
+
+    if (!handler_dma_instalado) {
+        irq_add_shared_handler(DMA_IRQ_0, irq_dma_rx, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        handler_dma_instalado = true;
+    }
+    dma_channel_set_irq0_enabled(rx->canal, true);
+
+    dma_channel_configure(rx->canal, &c, anel, &uart_get_hw(uart)->dr,
+                          TRANSFERENCIAS_POR_DISPARO, true);
+
+    if (ao_receber && timeout_us > 0) {
+        add_alarm_in_us(MAX(timeout_us, UART_RX_DMA_OCIOSO_US), verificar_linha, rx, true);
+    }
+}
+
+/**
+ * Bytes disponiveis, descartando os que ja foram sobrescritos.
+ * Chamada com a trava.
+ */
+static uint32_t disponivel(uart_rx_dma_t *rx) {
+    uint32_t n = escritos(rx) - rx->consumidos;
+
+    if (n > rx->mascara + 1u) {
+        rx->perdidos += n - (rx->mascara + 1u);
+        rx->consumidos += n - (rx->mascara + 1u);
+        n = rx->mascara + 1u;
+    }
+    return n;
+}
+
+uint32_t uart_rx_dma_disponivel(uart_rx_dma_t *rx) {
+    uint32_t salvo = spin_lock_blocking(rx->trava);
+    uint32_t n = disponivel(rx);
+    spin_unlock(rx->trava, salvo);
+    return n;
+}
+
+uint32_t uart_rx_dma_peek(uart_rx_dma_t *rx, const uint8_t **dados) {
+    uint32_t salvo = spin_lock_blocking(rx->trava);
+    uint32_t n = disponivel(rx);
+    uint32_t inicio = rx->consumidos & rx->mascara;
+    spin_unlock(rx->trava, salvo);
+
+    *dados = &rx->anel[inicio];
+    return MIN(n, rx->mascara + 1u - inicio);
+}
+
+bool uart_rx_dma_consume(uart_rx_dma_t *rx, uint32_t n) {
+    uint32_t salvo = spin_lock_blocking(rx->trava);
+
+    // disponivel() descarta (e conta) o que o DMA sobrescreveu desde o
+    // peek, a partir do inicio do trecho lido
+    uint32_t antes = rx->consumidos;
+    uint32_t restantes = disponivel(rx);
+    uint32_t sobrescritos = MIN(n, rx->consumidos - antes);
+    rx->consumidos += MIN(n - sobrescritos, restantes);
+
+    spin_unlock(rx->trava, salvo);
+    return sobrescritos == 0;
+}
+
+uint32_t uart_rx_dma_perdidos(uart_rx_dma_t *rx) {
+    return rx->perdidos;
+}
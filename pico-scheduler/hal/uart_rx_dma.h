@@ -0,0 +1,117 @@
+#ifndef UART_RX_DMA_H
+#define UART_RX_DMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/uart.h"
+#include "hardware/sync.h"
+#include "pico/time.h"
+
+/**
+ * Recepcao continua pela UART usando DMA.
+ *
+ * Com os FIFOs habilitados, um canal de DMA copia os bytes recebidos para
+ * um anel de tamanho potencia de 2 (channel_config_set_ring), sem IRQ por
+ * caractere. Quem consome le direto do anel com uart_rx_dma_peek e libera
+ * o espaco com uart_rx_dma_consume, sem copia.
+ *
+ * Quadros parciais sao sinalizados por um timeout de recepcao: quando a
+ * linha fica parada depois de receber dados, o callback e chamado. A IRQ
+ * RTIM da propria UART nao serve aqui, pois so dispara com bytes parados
+ * no FIFO e o DMA o esvazia a cada caractere; o timeout e verificado por
+ * um alarme do SDK. Com a linha parada, o alarme so confere a chegada de
+ * dados a cada UART_RX_DMA_OCIOSO_US; depois que chegam dados, passa a
+ * conferir a cada timeout_us, ate a linha parar de novo. O callback vem
+ * assim ate UART_RX_DMA_OCIOSO_US + 2 * timeout_us depois do fim do quadro.
+ */
+
+/**
+ * Intervalo de verificacao com a linha parada (maior que timeout_us)
+ */
+#ifndef UART_RX_DMA_OCIOSO_US
+#define UART_RX_DMA_OCIOSO_US 10000
+#endif
+
+/**
+ * Chamada (em IRQ de alarme) quando a linha fica parada depois de receber dados
+ */
+typedef void (*uart_rx_dma_callback_t)(void *contexto);
+
+/**
+ * Estado de uma UART com recepcao por DMA. Os campos sao internos.
+ */
+typedef struct {
+    uart_inst_t *uart;
+    uint canal;
+    spin_lock_t *trava;
+    uint8_t *anel;
+    uint32_t mascara;
+
+    // Contadores livres (modulo 2^32) de bytes escritos e consumidos
+    uint32_t base_escritos;
+    uint32_t consumidos;
+    uint32_t perdidos;
+
+    // Timeout de recepcao
+    uint32_t timeout_us;
+    uint32_t ultimo_visto;
+    bool recebendo;
+
+    uart_rx_dma_callback_t ao_receber;
+    void *contexto;
+} uart_rx_dma_t;
+
+/**
+ * Inicia a recepcao por DMA numa UART ja inicializada (uart_init)
+ *
+ * Habilita os FIFOs, reserva um canal de DMA e instala o handler
+ * compartilhado de DMA_IRQ_0 no core atual.
+ * @param rx Estado a ser inicializado (deve permanecer valido)
+ * @param uart UART de origem
+ * @param anel Buffer de 2^bits bytes, alinhado ao proprio tamanho
+ *             (ex.: __attribute__((aligned(1024))) para bits = 10)
+ * @param bits Log2 do tamanho do anel (1 a 15)
+ * @param timeout_us Tempo de linha parada que encerra um quadro
+ *                   (ex.: 32 bits de tempo; 0 desativa o callback)
+ * @param ao_receber Callback de linha parada (pode ser NULL)
+ * @param contexto Repassado ao callback
+ */
+void uart_rx_dma_init(uart_rx_dma_t *rx, uart_inst_t *uart, uint8_t *anel, uint bits,
+                      uint32_t timeout_us, uart_rx_dma_callback_t ao_receber, void *contexto);
+
+/**
+ * Bytes recebidos e ainda nao consumidos
+ */
+uint32_t uart_rx_dma_disponivel(uart_rx_dma_t *rx);
+
+/**
+ * Da acesso aos bytes recebidos sem copia-los
+ *
+ * Devolve o maior trecho continuo a partir do proximo byte nao consumido;
+ * quando os dados dao a volta no anel, o restante vem na chamada seguinte.
+ * Se o DMA tiver sobrescrito dados nao consumidos, eles sao descartados e
+ * contados em uart_rx_dma_perdidos.
+ * @param rx Estado da UART
+ * @param dados Recebe o endereco do trecho
+ * @return Tamanho do trecho (0 se nao houver dados)
+ */
+uint32_t uart_rx_dma_peek(uart_rx_dma_t *rx, const uint8_t **dados);
+
+/**
+ * Libera `n` bytes lidos com uart_rx_dma_peek
+ *
+ * O DMA continua escrevendo entre o peek e esta chamada; se nesse meio
+ * tempo ele deu a volta no anel e sobrescreveu parte do trecho, os bytes
+ * lidos nao sao confiaveis. Os sobrescritos sao descartados e contados em
+ * uart_rx_dma_perdidos.
+ * @return false se parte do trecho foi sobrescrita depois do peek
+ */
+bool uart_rx_dma_consume(uart_rx_dma_t *rx, uint32_t n);
+
+/**
+ * Bytes sobrescritos antes de serem consumidos
+ */
+uint32_t uart_rx_dma_perdidos(uart_rx_dma_t *rx);
+
+#endif
@@ -0,0 +1,149 @@
+#include "uart_tx_dma.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+/**
+ * UARTs registradas no handler de DMA_IRQ_0
+ */
+static uart_tx_dma_t *instancias[NUM_UARTS];
+static bool handler_instalado = false;
+
+/**
+ * Monta o lote com todos os buffers enfileirados e dispara o canal de
+ * controle. Chamada com a trava e sem lote em andamento.
+ */
+static void iniciar_lote(uart_tx_dma_t *tx) {
+    uint32_t n = 0;
+
+    for (; n < tx->tamanho; n++) {
+        const uart_tx_dma_buffer_t *buffer = &tx->fila[(tx->inicio + n) % UART_TX_DMA_FILA];
+        tx->lote[n].tamanho = buffer->tamanho;
+        tx->lote[n].dados = buffer->dados;
+    }
+    tx->lote[n].tamanho = 0;
+    tx->lote[n].dados = NULL;
+
+    tx->em_envio = n;
+    if (n > 0) {
+        dma_channel_set_read_addr(tx->canal_controle, &tx->lote[0], true);
+    }
+}
+
+/**
+ * Fim de lote de uma UART: libera os buffers enviados, inicia o proximo
+ * lote e chama os callbacks fora da trava
+ */
+static void concluir_lote(uart_tx_dma_t *tx) {
+    uart_tx_dma_buffer_t concluidos[UART_TX_DMA_FILA];
+
+    uint32_t salvo = spin_lock_blocking(tx->trava);
+    uint32_t n = tx->em_envio;
+    for (uint32_t i = 0; i < n; i++) {
+        concluidos[i] = tx->fila[(tx->inicio + i) % UART_TX_DMA_FILA];
+    }
+    tx->inicio = (tx->inicio + n) % UART_TX_DMA_FILA;
+    tx->tamanho -= n;
+    iniciar_lote(tx);
+    spin_unlock(tx->trava, salvo);
+
+    for (uint32_t i = 0; i < n; i++) {
+        if (concluidos[i].concluido) {
+            concluidos[i].concluido(concluidos[i].contexto);
+        }
+    }
+}
+
+/**
+ * Handler compartilhado de DMA_IRQ_0. Com irq_quiet, o canal de dados so
+ * sinaliza quando recebe o gatilho nulo do fim do lote.
+ */
+static void irq_dma_tx(void) {
+    for (uint i = 0; i < NUM_UARTS; i++) {
+        uart_tx_dma_t *tx = instancias[i];
+        if (tx && dma_channel_get_irq0_status(tx->canal_dados)) {
+            dma_channel_acknowledge_irq0(tx->canal_dados);
+            concluir_lote(tx);
+        }
+    }
+}
+
+void uart_tx_dma_init(uart_tx_dma_t *tx, uart_inst_t *uart) {
+    tx->uart = uart;
+    tx->inicio = 0;
+    tx->tamanho = 0;
+    tx->em_envio = 0;
+    tx->trava = spin_lock_instance((uint) spin_lock_claim_unused(true));
+    tx->canal_controle = (uint) dma_claim_unused_channel(true);
+    tx->canal_dados = (uint) dma_claim_unused_channel(true);
+
+    // Controle: escreve {tamanho, endereco} nos dois ultimos registradores do
+    // alias 3 do canal de dados; o anel de 8 bytes repete o destino a cada bloco
+    dma_channel_config c = dma_channel_get_default_config(tx->canal_controle);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 3);
+    dma_channel_configure(tx->canal_controle, &c, &dma_hw->ch[tx->canal_dados].al3_transfer_count,
+                          &tx->lote[0], 2, false);
+
+    // Dados: bytes para o FIFO no ritmo do DREQ de TX, encadeando no controle
+    c = dma_channel_get_default_config(tx->canal_dados);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, true));
+    channel_config_set_chain_to(&c, tx->canal_controle);
+    channel_config_set_irq_quiet(&c, true);
+    dma_channel_configure(tx->canal_dados, &c, &uart_get_hw(uart)->dr, NULL, 0, false);
+
+    if (!handler_instalado) {
+        irq_add_shared_handler(DMA_IRQ_0, irq_dma_tx, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        handler_instalado = true;
+    }
+    instancias[uart_get_index(uart)] = tx;
+    dma_channel_set_irq0_enabled(tx->canal_dados, true);
+}
+
+bool uart_tx_dma_enviar(uart_tx_dma_t *tx, const void *dados, uint32_t tamanho,
+                        uart_tx_dma_callback_t concluido, void *contexto) {
+    // Um bloco de tamanho 0 seria confundido com o fim do lote
+    if (tamanho == 0) {
+        return false;
+    }
+
+    uint32_t salvo = spin_lock_blocking(tx->trava);
+
+    if (tx->tamanho >= UART_TX_DMA_FILA) {
+        spin_unlock(tx->trava, salvo);
+        return false;
+    }
+
+    tx->fila[(tx->inicio + tx->tamanho) % UART_TX_DMA_FILA] = (uart_tx_dma_buffer_t) {
+        .dados = dados,
+        .tamanho = tamanho,
+        .concluido = concluido,
+        .contexto = contexto,
+    };
+    tx->tamanho++;
+
+    // Sem lote em andamento: comeca agora. Do contrario, o buffer entra no
+    // proximo lote, montado pela IRQ de fim de lote.
+    if (tx->em_envio == 0) {
+        iniciar_lote(tx);
+    }
+
+    spin_unlock(tx->trava, salvo);
+    return true;
+}
+
+uint32_t uart_tx_dma_pendentes(uart_tx_dma_t *tx) {
+    uint32_t salvo = spin_lock_blocking(tx->trava);
+    uint32_t pendentes = tx->tamanho;
+    spin_unlock(tx->trava, salvo);
+    return pendentes;
+}
+
+void uart_tx_dma_esperar(uart_tx_dma_t *tx) {
+    while (uart_tx_dma_pendentes(tx) > 0) {
+        tight_loop_contents();
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef UART_TX_DMA_H
+#define UART_TX_DMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/uart.h"
+#include "hardware/sync.h"
+
+/**
+ * Envio assincrono pela UART usando DMA.
+ *
+ * Os buffers entram numa fila e sao enviados em lotes: um canal de controle
+ * carrega cada par {tamanho, endereco} no canal de dados (como no exemplo
+ * dma/control_blocks) e o canal de dados escreve no FIFO da UART no ritmo
+ * do DREQ de TX. A CPU so participa ao enfileirar e na IRQ de fim de lote
+ * (DMA_IRQ_0, handler compartilhado), onde os callbacks sao chamados.
+ */
+
+/**
+ * Numero de buffers pendentes por UART
+ */
+#ifndef UART_TX_DMA_FILA
+#define UART_TX_DMA_FILA 8
+#endif
+
+/**
+ * Chamada quando o buffer foi todo entregue a UART e pode ser reutilizado.
+ * Executa na IRQ de DMA do core que chamou uart_tx_dma_init.
+ */
+typedef void (*uart_tx_dma_callback_t)(void *contexto);
+
+typedef struct {
+    const uint8_t *dados;
+    uint32_t tamanho;
+    uart_tx_dma_callback_t concluido;
+    void *contexto;
+} uart_tx_dma_buffer_t;
+
+/**
+ * Estado de uma UART com envio por DMA. Os campos sao internos.
+ */
+typedef struct {
+    uart_inst_t *uart;
+    uint canal_dados;
+    uint canal_controle;
+    spin_lock_t *trava;
+
+    // Buffers enfileirados: [inicio, inicio + em_envio) estao no lote atual
+    uart_tx_dma_buffer_t fila[UART_TX_DMA_FILA];
+    uint32_t inicio;
+    uint32_t tamanho;
+    uint32_t em_envio;
+
+    // Blocos de controle do lote atual, terminados por {0, NULL}
+    struct {
+        uint32_t tamanho;
+        const uint8_t *dados;
+    } lote[UART_TX_DMA_FILA + 1];
+} uart_tx_dma_t;
+
+/**
+ * Prepara o envio por DMA numa UART ja inicializada (uart_init)
+ *
+ * Reserva dois canais de DMA. O estado deve permanecer valido (estatico)
+ * enquanto a UART for usada.
+ * @param tx Estado a ser inicializado
+ * @param uart UART de destino
+ */
+void uart_tx_dma_init(uart_tx_dma_t *tx, uart_inst_t *uart);
+
+/**
+ * Enfileira um buffer para envio sem esperar
+ *
+ * O buffer nao pode ser alterado ate o callback ser chamado. Pode ser
+ * chamada de qualquer core e de IRQs.
+ * @param tx Estado da UART
+ * @param dados Bytes a enviar
+ * @param tamanho Quantidade de bytes (maior que 0)
+ * @param concluido Callback de conclusao (pode ser NULL)
+ * @param contexto Repassado ao callback
+ * @return false se a fila estiver cheia ou o buffer vazio (nada foi enfileirado)
+ */
+bool uart_tx_dma_enviar(uart_tx_dma_t *tx, const void *dados, uint32_t tamanho,
+                        uart_tx_dma_callback_t concluido, void *contexto);
+
+/**
+ * Quantidade de buffers ainda nao concluidos
+ */
+uint32_t uart_tx_dma_pendentes(uart_tx_dma_t *tx);
+
+/**
+ * Espera todos os buffers enfileirados serem entregues a UART
+ */
+void uart_tx_dma_esperar(uart_tx_dma_t *tx);
+
+#endif
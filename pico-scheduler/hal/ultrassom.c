@@ -0,0 +1,217 @@
+#include "ultrassom.h"
+#include "hardware/clocks.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "medida_fixa.h"
+#include "pico/time.h"
+#include "ultrassom.pio.h"
+
+#if (ULTRASSOM_MEDIANA % 2) == 0
+#error "ULTRASSOM_MEDIANA deve ser impar"
+#endif
+
+/**
+ * Resposta da maquina de estado quando nao houve eco
+ */
+#define SEM_ECO 0xffffffffu
+
+/**
+ * Relogio das maquinas de estado: 2 instrucoes por us
+ */
+#define RELOGIO_PIO_HZ 2000000u
+
+/**
+ * Estado de um sensor. `sequencia` e impar enquanto o temporizador
+ * escreve `leitura`.
+ */
+typedef struct {
+    PIO pio;
+    uint sm;
+    bool em_medida;
+    volatile uint32_t sequencia;
+    ultrassom_leitura_t leitura;
+    uint32_t historico[ULTRASSOM_MEDIANA];
+    uint32_t num_historico;
+    uint32_t proximo_historico;
+} sensor_t;
+
+static sensor_t sensores[ULTRASSOM_MAX_SENSORES];
+static volatile uint32_t num_sensores = 0;
+
+/**
+ * Posicao do programa em cada PIO, carregado no primeiro sensor dele
+ */
+static uint offsets[NUM_PIOS];
+static bool programa_carregado[NUM_PIOS];
+
+static repeating_timer_t temporizador;
+static uint32_t limite;
+static ultrassom_callback_t callback_amostra;
+static void *contexto_amostra;
+
+/**
+ * Mediana das medidas no historico (ordenacao por insercao de ate
+ * ULTRASSOM_MEDIANA valores)
+ */
+static uint32_t mediana(const sensor_t *s) {
+    uint32_t ordenado[ULTRASSOM_MEDIANA];
+
+    for (uint32_t i = 0; i < s->num_historico; i++) {
+        uint32_t v = s->historico[i];
+        uint32_t j = i;
+        for (; j > 0 && ordenado[j - 1] > v; j--) {
+            ordenado[j] = ordenado[j - 1];
+        }
+        ordenado[j] = v;
+    }
+    return ordenado[s->num_historico / 2];
+}
+
+/**
+ * Filtra e publica a resposta de uma medida
+ */
+static void publicar(sensor_t *s, uint32_t resposta, uint32_t agora_us) {
+    s->sequencia++;
+    __dmb();
+
+    if (resposta == SEM_ECO) {
+        s->leitura.sem_eco++;
+    } else {
+        uint32_t bruta = medida_fixa_distancia_um(limite - resposta);
+
+        s->historico[s->proximo_historico] = bruta;
+        s->proximo_historico = (s->proximo_historico + 1) % ULTRASSOM_MEDIANA;
+        if (s->num_historico < ULTRASSOM_MEDIANA) {
+            s->num_historico++;
+        }
+
+        uint32_t filtrada = mediana(s);
+        uint32_t anterior = s->leitura.distancia_um;
+        if (s->leitura.amostras == 0) {
+            anterior = filtrada;
+        } else if (filtrada >= anterior) {
+            anterior += (filtrada - anterior) >> ULTRASSOM_EMA_BITS;
+        } else {
+            anterior -= (anterior - filtrada) >> ULTRASSOM_EMA_BITS;
+        }
+
+        s->leitura.distancia_um = anterior;
+        s->leitura.bruta_um = bruta;
+        s->leitura.amostras++;
+    }
+    s->leitura.instante_us = agora_us;
+
+    __dmb();
+    s->sequencia++;
+}
+
+/**
+ * Recolhe a medida anterior de cada sensor e dispara todos de novo
+ */
+static bool disparar(repeating_timer_t *t) {
+    (void) t;
+    uint32_t agora_us = time_us_32();
+    uint32_t n = num_sensores;
+
+    for (uint32_t i = 0; i < n; i++) {
+        sensor_t *s = &sensores[i];
+
+        if (s->em_medida) {
+            // Ainda esperando o eco anterior terminar: pula este disparo
+            if (pio_sm_is_rx_fifo_empty(s->pio, s->sm)) {
+                continue;
+            }
+            publicar(s, pio_sm_get(s->pio, s->sm), agora_us);
+            s->em_medida = false;
+
+            if (callback_amostra) {
+                callback_amostra(i, &s->leitura, contexto_amostra);
+            }
+        }
+
+        pio_sm_put(s->pio, s->sm, limite);
+        s->em_medida = true;
+    }
+    return true;
+}
+
+bool ultrassom_init(uint32_t periodo_us, uint32_t limite_us, ultrassom_callback_t callback,
+                    void *contexto) {
+    if (limite_us == 0 || periodo_us / 2 <= limite_us) {
+        return false;
+    }
+
+    limite = limite_us;
+    callback_amostra = callback;
+    contexto_amostra = contexto;
+    return add_repeating_timer_us(-(int64_t) periodo_us, disparar, NULL, &temporizador);
+}
+
+/**
+ * Reserva uma maquina de estado num PIO que tenha (ou comporte) o programa
+ * @return false se nenhum PIO puder receber o sensor
+ */
+static bool reservar(sensor_t *s) {
+    for (uint i = 0; i < NUM_PIOS; i++) {
+        PIO pio = pio_get_instance(i);
+        if (!programa_carregado[i] && !pio_can_add_program(pio, &ultrassom_program)) {
+            continue;
+        }
+
+        int sm = pio_claim_unused_sm(pio, false);
+        if (sm < 0) {
+            continue;
+        }
+
+        if (!programa_carregado[i]) {
+            offsets[i] = pio_add_program(pio, &ultrassom_program);
+            programa_carregado[i] = true;
+        }
+        s->pio = pio;
+        s->sm = (uint) sm;
+        return true;
+    }
+    return false;
+}
+
+int ultrassom_adicionar(uint32_t pino_disparo, uint32_t pino_eco) {
+    if (num_sensores >= ULTRASSOM_MAX_SENSORES) {
+        return -1;
+    }
+
+    sensor_t *s = &sensores[num_sensores];
+    *s = (sensor_t) { 0 };
+    if (!reservar(s)) {
+        return -1;
+    }
+
+    // Divisor em 1/256 para RELOGIO_PIO_HZ, sem float
+    uint32_t divisor = (uint32_t) (((uint64_t) clock_get_hz(clk_sys) << 8) / RELOGIO_PIO_HZ);
+    ultrassom_program_init(s->pio, s->sm, offsets[pio_get_index(s->pio)], pino_disparo,
+                           pino_eco, (uint16_t) (divisor >> 8), (uint8_t) divisor);
+
+    // O sensor entra no proximo disparo do temporizador
+    uint32_t salvo = save_and_disable_interrupts();
+    int indice = (int) num_sensores++;
+    restore_interrupts(salvo);
+    return indice;
+}
+
+bool ultrassom_ler(uint32_t sensor, ultrassom_leitura_t *leitura) {
+    if (sensor >= num_sensores) {
+        return false;
+    }
+
+    const sensor_t *s = &sensores[sensor];
+    uint32_t sequencia;
+
+    // Repete se o temporizador publicou durante a copia
+    do {
+        sequencia = s->sequencia;
+        __dmb();
+        *leitura = s->leitura;
+        __dmb();
+    } while ((sequencia & 1u) || sequencia != s->sequencia);
+
+    return leitura->amostras > 0;
+}
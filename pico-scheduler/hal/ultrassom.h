@@ -0,0 +1,89 @@
+#ifndef ULTRASSOM_H
+#define ULTRASSOM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Leitura continua de varios sensores ultrassonicos (HC-SR04) sem ocupar
+ * a CPU: uma maquina de estado do PIO por sensor gera o pulso de disparo e
+ * mede a largura do eco em passos de 1 us, com limite de espera.
+ *
+ * Um temporizador repetitivo recolhe a medida anterior de cada sensor e
+ * dispara a seguinte em todos ao mesmo tempo, na taxa configurada. Cada
+ * amostra passa por uma mediana das ultimas ULTRASSOM_MEDIANA medidas
+ * (remove ecos espurios) e por uma media movel exponencial. O resultado e
+ * publicado num instantaneo (seqlock, como em captura_pwm) e entregue ao
+ * callback, se houver.
+ *
+ * Sensores disparados juntos podem ouvir o eco uns dos outros: se
+ * apontarem para a mesma regiao, afaste-os ou monte-os em angulos
+ * diferentes.
+ */
+
+/**
+ * Maximo de sensores: as 8 maquinas de estado dos dois PIOs
+ */
+#define ULTRASSOM_MAX_SENSORES 8
+
+/**
+ * Numero de medidas na mediana (impar)
+ */
+#ifndef ULTRASSOM_MEDIANA
+#define ULTRASSOM_MEDIANA 5
+#endif
+
+/**
+ * Peso da amostra nova na media movel: 1 / 2^ULTRASSOM_EMA_BITS
+ */
+#ifndef ULTRASSOM_EMA_BITS
+#define ULTRASSOM_EMA_BITS 2
+#endif
+
+/**
+ * Ultima medida de um sensor
+ */
+typedef struct {
+    uint32_t distancia_um; // filtrada (mediana e media movel)
+    uint32_t bruta_um;     // ultima medida com eco, sem filtro
+    uint32_t amostras;     // medidas com eco
+    uint32_t sem_eco;      // medidas sem eco dentro do limite
+    uint32_t instante_us;  // quando a ultima medida foi recolhida (time_us_32)
+} ultrassom_leitura_t;
+
+/**
+ * Recebe cada amostra nova. Chamado dentro da IRQ do temporizador.
+ * @param sensor Indice devolvido por ultrassom_adicionar
+ */
+typedef void (*ultrassom_callback_t)(uint32_t sensor, const ultrassom_leitura_t *leitura,
+                                     void *contexto);
+
+/**
+ * Inicia o temporizador compartilhado no core atual
+ * @param periodo_us Intervalo entre disparos (60 ms ou mais para o HC-SR04)
+ * @param limite_us Maior espera pelo eco e maior largura de eco aceitas
+ *                  (~5,8 us por mm de distancia); periodo_us deve passar
+ *                  de 2 * limite_us
+ * @param callback Chamado a cada amostra (pode ser NULL)
+ * @return false se o periodo nao comportar o limite
+ */
+bool ultrassom_init(uint32_t periodo_us, uint32_t limite_us, ultrassom_callback_t callback,
+                    void *contexto);
+
+/**
+ * Passa a medir um sensor a partir do proximo disparo. Chame sempre do
+ * mesmo core.
+ * @param pino_disparo Pino ligado ao TRIG
+ * @param pino_eco Pino ligado ao ECHO
+ * @return Indice do sensor, ou -1 sem maquina de estado ou espaco para o
+ *         programa nos PIOs
+ */
+int ultrassom_adicionar(uint32_t pino_disparo, uint32_t pino_eco);
+
+/**
+ * Copia a ultima medida de um sensor, sem bloquear
+ * @return false se o sensor nao existir ou ainda nao houver medida com eco
+ */
+bool ultrassom_ler(uint32_t sensor, ultrassom_leitura_t *leitura);
+
+#endif
@@ -0,0 +1,111 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "crc32.h"
+
+/**
+ * Benchmark dos caminhos de software do CRC-32 no host: confere que todos
+ * dao o mesmo resultado e mede MB/s para varios tamanhos de bloco.
+ * O caminho do sniffer de DMA so existe no RP2040 e nao entra aqui.
+ *
+ * Uso: bench_crc32 [megabytes por medida]
+ */
+
+typedef uint32_t (*funcao_crc_t)(uint32_t estado, const void *dados, size_t tamanho);
+
+static const struct {
+    const char *nome;
+    funcao_crc_t funcao;
+} variantes[] = {
+    { "bit", crc32_update_bit },
+    { "tabela", crc32_update_tabela },
+    { "slice4", crc32_update_slice4 },
+    { "slice8", crc32_update_slice8 },
+};
+
+#define NUM_VARIANTES (sizeof(variantes) / sizeof(variantes[0]))
+
+static const size_t tamanhos[] = { 16, 64, 256, 1024, 4096, 65536 };
+
+#define NUM_TAMANHOS (sizeof(tamanhos) / sizeof(tamanhos[0]))
+#define MAIOR_BLOCO 65536
+
+static double segundos_desde(const struct timespec *inicio) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (double) (agora.tv_sec - inicio->tv_sec) +
+           (double) (agora.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+/**
+ * Confere o valor padrao de "123456789" e a concordancia entre os caminhos
+ * em todos os tamanhos e desalinhamentos
+ */
+static bool conferir(const uint8_t *dados) {
+    static const char padrao[] = "123456789";
+
+    for (size_t v = 0; v < NUM_VARIANTES; v++) {
+        if (crc32_final(variantes[v].funcao(CRC32_INIT, padrao, 9)) != 0xcbf43926u) {
+            fprintf(stderr, "%s: CRC de \"123456789\" incorreto\n", variantes[v].nome);
+            return false;
+        }
+    }
+
+    for (size_t tamanho = 0; tamanho < 64; tamanho++) {
+        for (size_t deslocamento = 0; deslocamento < 8; deslocamento++) {
+            uint32_t esperado = crc32_update_bit(CRC32_INIT, dados + deslocamento, tamanho);
+            for (size_t v = 1; v < NUM_VARIANTES; v++) {
+                if (variantes[v].funcao(CRC32_INIT, dados + deslocamento, tamanho) != esperado) {
+                    fprintf(stderr, "%s: diverge com %zu bytes\n", variantes[v].nome, tamanho);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+    uint8_t *dados = malloc(MAIOR_BLOCO + 8);
+
+    srand(1);
+    for (size_t i = 0; i < MAIOR_BLOCO + 8; i++) {
+        dados[i] = (uint8_t) rand();
+    }
+
+    if (!conferir(dados)) {
+        return 1;
+    }
+
+    printf("%8s", "bytes");
+    for (size_t v = 0; v < NUM_VARIANTES; v++) {
+        printf(" %10s", variantes[v].nome);
+    }
+    printf("   (MB/s)\n");
+
+    for (size_t t = 0; t < NUM_TAMANHOS; t++) {
+        printf("%8zu", tamanhos[t]);
+
+        for (size_t v = 0; v < NUM_VARIANTES; v++) {
+            // O bitwise e lento: mede menos dados para nao demorar
+            size_t total = megabytes * 1024u * 1024u / (v == 0 ? 16u : 1u);
+            size_t repeticoes = total / tamanhos[t] + 1u;
+            volatile uint32_t resultado = 0;
+            struct timespec inicio;
+
+            clock_gettime(CLOCK_MONOTONIC, &inicio);
+            for (size_t r = 0; r < repeticoes; r++) {
+                resultado += variantes[v].funcao(CRC32_INIT, dados, tamanhos[t]);
+            }
+            double segundos = segundos_desde(&inicio);
+
+            printf(" %10.1f", (double) (repeticoes * tamanhos[t]) / segundos / 1e6);
+        }
+        printf("\n");
+    }
+
+    free(dados);
+    return 0;
+}
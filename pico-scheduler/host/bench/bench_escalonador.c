@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "pico.h"
+#include "pico/time.h"
+#include "scheduler.h"
+#include "console.h"
+#include "simulador.h"
+
+/**
+ * Benchmark do escalonador no host.
+ *
+ * Para cada quantidade de tarefas, adiciona tarefas com periodos e custos
+ * variados, simula alguns segundos de relogio virtual e resume:
+ * - custo de despacho: tempo real do host por execucao (escalonador +
+ *   simulador), util para comparar versoes na mesma maquina;
+ * - latencia de liberacao (jitter) e prazos perdidos, em tempo virtual,
+ *   que dependem so do algoritmo e sao reproduziveis.
+ *
+ * Uso: bench_escalonador [-p prioridade|rm|edf] [-t segundos] [N ...]
+ */
+
+static const uint32_t periodos_ms[] = { 1, 2, 5, 10, 20, 50, 100 };
+
+/**
+ * Tarefas que simulam trabalho de custo fixo (as tarefas nao recebem
+ * contexto, entao ha uma funcao por custo)
+ */
+#define TAREFA_COM_CUSTO(custo_us) \
+    static void tarefa_##custo_us##us(void) { sim_avancar_us(custo_us); }
+
+TAREFA_COM_CUSTO(2)
+TAREFA_COM_CUSTO(5)
+TAREFA_COM_CUSTO(10)
+TAREFA_COM_CUSTO(20)
+
+static const funcao_tarefa_t tarefas_custo[] = { tarefa_2us, tarefa_5us, tarefa_10us, tarefa_20us };
+
+static tarefa_handle_t handles[SCHEDULER_MAX_TASKS];
+static uint32_t num_tarefas = 0;
+static struct timespec inicio_host;
+
+static uint64_t ns_desde(const struct timespec *inicio) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t) (agora.tv_sec - inicio->tv_sec) * 1000000000u +
+           (uint64_t) (agora.tv_nsec - inicio->tv_nsec);
+}
+
+/**
+ * Maior latencia da faixa do histograma (0, 1, 2-3, 4-7 us, ...)
+ */
+static uint32_t limite_faixa_us(uint32_t faixa) {
+    return faixa == 0 ? 0 : (1u << faixa) - 1u;
+}
+
+/**
+ * Chamada pelo simulador no fim do tempo virtual: escreve uma linha da tabela
+ */
+static void relatorio(void) {
+    uint64_t ns = ns_desde(&inicio_host);
+    uint64_t execucoes = 0;
+    uint64_t perdidos = 0;
+    uint64_t pulados = 0;
+    uint32_t jitter_max_us = 0;
+    uint64_t histograma[SCHEDULER_STATS_BUCKETS] = { 0 };
+
+    for (uint32_t i = 0; i < num_tarefas; i++) {
+        tarefa_stats_t stats;
+        if (!scheduler_get_stats(handles[i], &stats)) {
+            continue;
+        }
+        execucoes += stats.execucoes;
+        perdidos += stats.prazos_perdidos;
+        pulados += stats.disparos_pulados;
+        jitter_max_us = MAX(jitter_max_us, stats.jitter_max_us);
+        for (uint32_t faixa = 0; faixa < SCHEDULER_STATS_BUCKETS; faixa++) {
+            histograma[faixa] += stats.histograma_latencia[faixa];
+        }
+    }
+
+    // Percentis pela faixa do histograma (limite superior)
+    uint32_t p50_us = 0;
+    uint32_t p99_us = 0;
+    uint64_t acumulado = 0;
+    for (uint32_t faixa = 0; faixa < SCHEDULER_STATS_BUCKETS; faixa++) {
+        uint64_t antes = acumulado;
+        acumulado += histograma[faixa];
+        if (antes * 2 < execucoes && acumulado * 2 >= execucoes) {
+            p50_us = limite_faixa_us(faixa);
+        }
+        if (antes * 100 < execucoes * 99 && acumulado * 100 >= execucoes * 99) {
+            p99_us = limite_faixa_us(faixa);
+        }
+    }
+
+    scheduler_uso_core_t uso;
+    scheduler_get_core_usage(0, &uso);
+    uint32_t permil = scheduler_uso_ocioso_permil(&uso);
+
+    printf("%8lu %10llu %12.1f %8lu %8lu %8lu %9llu %8llu %5lu.%lu%%\n",
+           (unsigned long) num_tarefas, (unsigned long long) execucoes,
+           execucoes ? (double) ns / (double) execucoes : 0.0,
+           (unsigned long) p50_us, (unsigned long) p99_us, (unsigned long) jitter_max_us,
+           (unsigned long long) perdidos, (unsigned long long) pulados,
+           (unsigned long) (permil / 10), (unsigned long) (permil % 10));
+    fflush(stdout);
+}
+
+/**
+ * Executa uma simulacao (no processo filho; scheduler_start nao retorna)
+ */
+static void simular(uint32_t n, politica_escalonamento_t politica, uint32_t segundos) {
+    sim_reiniciar();
+    console_init();
+    scheduler_init();
+    scheduler_set_policy(politica);
+
+    num_tarefas = n;
+    for (uint32_t i = 0; i < n; i++) {
+        tarefa_config_t config = scheduler_task_config(tarefas_custo[i % count_of(tarefas_custo)],
+                                                       periodos_ms[i % count_of(periodos_ms)]);
+        config.prioridade = (uint8_t) (255u - i % 256u);
+        handles[i] = scheduler_add_task_config(&config);
+    }
+
+    sim_definir_fim(time_us_64() + (uint64_t) segundos * 1000000u, relatorio);
+    clock_gettime(CLOCK_MONOTONIC, &inicio_host);
+    scheduler_start();
+}
+
+int main(int argc, char **argv) {
+    static const uint32_t padrao[] = { 4, 8, 16, 32, 64, 128, 256 };
+    politica_escalonamento_t politica = SCHEDULER_POLITICA_PRIORIDADE;
+    uint32_t segundos = 10;
+    int opcao;
+
+    while ((opcao = getopt(argc, argv, "p:t:")) != -1) {
+        if (opcao == 'p' && strcmp(optarg, "rm") == 0) {
+            politica = SCHEDULER_POLITICA_RM;
+        } else if (opcao == 'p' && strcmp(optarg, "edf") == 0) {
+            politica = SCHEDULER_POLITICA_EDF;
+        } else if (opcao == 'p' && strcmp(optarg, "prioridade") == 0) {
+            politica = SCHEDULER_POLITICA_PRIORIDADE;
+        } else if (opcao == 't') {
+            segundos = (uint32_t) strtoul(optarg, NULL, 10);
+        } else {
+            fprintf(stderr, "uso: %s [-p prioridade|rm|edf] [-t segundos] [N ...]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%8s %10s %12s %8s %8s %8s %9s %8s %7s\n", "tarefas", "execucoes", "despacho_ns",
+           "p50_us", "p99_us", "max_us", "perdidos", "pulados", "ocioso");
+
+    uint32_t total = optind < argc ? (uint32_t) (argc - optind) : count_of(padrao);
+    for (uint32_t i = 0; i < total; i++) {
+        uint32_t n = optind < argc ? (uint32_t) strtoul(argv[optind + (int) i], NULL, 10) : padrao[i];
+        if (n == 0 || n >= SCHEDULER_MAX_TASKS) {
+            fprintf(stderr, "N deve estar entre 1 e %d\n", SCHEDULER_MAX_TASKS - 1);
+            return 1;
+        }
+
+        // Cada simulacao num processo proprio: o escalonador nao retorna
+        fflush(stdout);
+        pid_t filho = fork();
+        if (filho == 0) {
+            simular(n, politica, segundos);
+        }
+
+        int estado;
+        if (filho < 0 || waitpid(filho, &estado, 0) < 0 || !WIFEXITED(estado) ||
+            WEXITSTATUS(estado) != 0) {
+            fprintf(stderr, "simulacao com %lu tarefas falhou\n", (unsigned long) n);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "medida_fixa.h"
+
+/**
+ * Confere as conversoes em ponto fixo de medida_fixa contra as formulas
+ * em float usadas antes nos exemplos (measure_duty_cycle e o sensor
+ * ultrassonico) e contra uma referencia em double, e mostra o maior erro
+ * de cada uma. Nao mede tempo: no host o float tem FPU, e a diferenca que
+ * interessa (soft-float no M0+) so aparece no RP2040.
+ *
+ * Uso: bench_medida [casos aleatorios]
+ */
+
+static uint64_t aleatorio64(void) {
+    uint64_t v = 0;
+    for (int i = 0; i < 4; i++) {
+        v = (v << 16) ^ (uint64_t) (rand() & 0xffff);
+    }
+    return v;
+}
+
+/**
+ * Razoes e valores aleatorios: o resultado deve ficar a meia unidade da
+ * referencia, mais o erro relativo do fator (2^-31)
+ */
+static bool conferir_escala(long casos) {
+    double maior_erro = 0;
+
+    for (long i = 0; i < casos; i++) {
+        uint64_t numerador = aleatorio64() >> (1 + rand() % 63);
+        uint64_t denominador = (aleatorio64() >> (1 + rand() % 63)) | 1u;
+        uint32_t valor = (uint32_t) (aleatorio64() >> (rand() % 64));
+        medida_fixa_escala_t escala;
+
+        double razao = (double) numerador / (double) denominador;
+        if (!medida_fixa_escala_init(&escala, numerador, denominador)) {
+            if (razao < 4294967295.0) {
+                fprintf(stderr, "escala %llu/%llu recusada\n", (unsigned long long) numerador,
+                        (unsigned long long) denominador);
+                return false;
+            }
+            continue;
+        }
+
+        double esperado = (double) valor * razao;
+        uint32_t obtido = medida_fixa_aplicar(&escala, valor);
+        if (esperado >= 4294967295.0) {
+            if (obtido != UINT32_MAX) {
+                fprintf(stderr, "%u * %g nao saturou: %u\n", valor, razao, obtido);
+                return false;
+            }
+            continue;
+        }
+
+        double erro = fabs((double) obtido - esperado);
+        if (erro > 0.5 + esperado * ldexp(1.0, -31) + 1e-6) {
+            fprintf(stderr, "%u * %llu/%llu = %u, esperado %.3f\n", valor,
+                    (unsigned long long) numerador, (unsigned long long) denominador, obtido,
+                    esperado);
+            return false;
+        }
+        if (erro > maior_erro) {
+            maior_erro = erro;
+        }
+    }
+
+    printf("escala:     %ld casos, maior erro %.3f unidade\n", casos, maior_erro);
+    return true;
+}
+
+/**
+ * Ciclo de trabalho como em measure_duty_cycle: divisor 100 e janela de
+ * 10 ms, em varios relogios do sistema
+ */
+static bool conferir_ciclo(void) {
+    static const uint32_t relogios[] = { 48000000u, 125000000u, 133000000u, 200000000u };
+    double maior_erro = 0;
+
+    for (size_t r = 0; r < sizeof(relogios) / sizeof(relogios[0]); r++) {
+        medida_fixa_escala_t escala;
+        if (!medida_fixa_ciclo_init(&escala, relogios[r], 100, 10000)) {
+            fprintf(stderr, "ciclo: escala recusada para %u Hz\n", relogios[r]);
+            return false;
+        }
+
+        float counting_rate = relogios[r] / 100;
+        float max_possible_count = counting_rate * 0.01;
+        uint32_t maximo = relogios[r] / 100u / 100u;
+
+        for (uint32_t contagem = 0; contagem <= maximo; contagem++) {
+            float ciclo_float = contagem / max_possible_count;
+            uint32_t ppm = medida_fixa_aplicar(&escala, contagem);
+            double erro = fabs((double) ppm - (double) ciclo_float * 1e6);
+            if (erro > 1.0) {
+                fprintf(stderr, "ciclo: %u contagens a %u Hz = %u ppm, float %.1f ppm\n",
+                        contagem, relogios[r], ppm, (double) ciclo_float * 1e6);
+                return false;
+            }
+            if (erro > maior_erro) {
+                maior_erro = erro;
+            }
+        }
+    }
+
+    printf("ciclo:      maior diferenca para o float %.3f ppm\n", maior_erro);
+    return true;
+}
+
+/**
+ * Frequencia a partir das bordas contadas em janelas de 1 a 100 ms
+ */
+static bool conferir_frequencia(void) {
+    static const uint32_t janelas[] = { 1000u, 10000u, 33333u, 100000u };
+    double maior_erro = 0;
+
+    for (size_t j = 0; j < sizeof(janelas) / sizeof(janelas[0]); j++) {
+        medida_fixa_escala_t escala;
+        medida_fixa_frequencia_init(&escala, janelas[j]);
+
+        for (uint32_t bordas = 0; bordas <= 65535u; bordas++) {
+            double esperado = (double) bordas * 1e9 / janelas[j];
+            uint32_t mhz = medida_fixa_aplicar(&escala, bordas);
+            double erro = esperado >= 4294967295.0 ? 0 : fabs((double) mhz - esperado);
+            if (erro > 1.0) {
+                fprintf(stderr, "frequencia: %u bordas em %u us = %u mHz, esperado %.1f\n",
+                        bordas, janelas[j], mhz, esperado);
+                return false;
+            }
+            if (erro > maior_erro) {
+                maior_erro = erro;
+            }
+        }
+    }
+
+    printf("frequencia: maior erro %.3f mHz\n", maior_erro);
+    return true;
+}
+
+/**
+ * Distancia do sensor ultrassonico ate 40 ms de eco (alem do alcance do
+ * HC-SR04), contra a formula em float do exemplo
+ */
+static bool conferir_distancia(void) {
+    double maior_erro = 0;
+
+    for (uint32_t eco_us = 0; eco_us <= 40000u; eco_us++) {
+        float distancia_cm = (eco_us * 0.0343f) / 2.0f;
+        uint32_t um = medida_fixa_distancia_um(eco_us);
+        double erro = fabs((double) um - (double) distancia_cm * 1e4);
+        if (erro > 1.0) {
+            fprintf(stderr, "distancia: eco de %u us = %u um, float %.2f um\n", eco_us, um,
+                    (double) distancia_cm * 1e4);
+            return false;
+        }
+        if (erro > maior_erro) {
+            maior_erro = erro;
+        }
+    }
+
+    printf("distancia:  maior diferenca para o float %.3f um\n", maior_erro);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    long casos = argc > 1 ? strtol(argv[1], NULL, 10) : 1000000;
+
+    srand(1);
+    if (!conferir_escala(casos) || !conferir_ciclo() || !conferir_frequencia() ||
+        !conferir_distancia()) {
+        return 1;
+    }
+
+    printf("ok\n");
+    return 0;
+}
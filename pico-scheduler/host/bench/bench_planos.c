@@ -0,0 +1,107 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "planos_bits.h"
+
+/**
+ * Confere a transposicao rapida de planos_bits contra o modelo de
+ * referencia (casos fixos e aleatorios) e mede as duas no host.
+ *
+ * Uso: bench_planos [milhoes de quadros por medida]
+ */
+
+typedef void (*funcao_transpor_t)(const uint16_t *ciclos, uint16_t *planos);
+
+static double segundos_desde(const struct timespec *inicio) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (double) (agora.tv_sec - inicio->tv_sec) +
+           (double) (agora.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+static bool comparar(const uint16_t ciclos[PLANOS_BITS_MAX]) {
+    uint16_t esperado[PLANOS_BITS_MAX];
+    uint16_t obtido[PLANOS_BITS_MAX];
+
+    planos_bits_transpor_referencia(ciclos, esperado);
+    planos_bits_transpor(ciclos, obtido);
+
+    for (int b = 0; b < PLANOS_BITS_MAX; b++) {
+        if (obtido[b] != esperado[b]) {
+            fprintf(stderr, "plano %d: 0x%04x, esperado 0x%04x\n", b, obtido[b], esperado[b]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Cada bit isolado, a matriz cheia e entradas aleatorias
+ */
+static bool conferir(void) {
+    uint16_t ciclos[PLANOS_BITS_MAX];
+
+    for (int c = 0; c < PLANOS_BITS_MAX; c++) {
+        for (int b = 0; b < PLANOS_BITS_MAX; b++) {
+            for (int i = 0; i < PLANOS_BITS_MAX; i++) {
+                ciclos[i] = 0;
+            }
+            ciclos[c] = (uint16_t) (1u << b);
+            if (!comparar(ciclos)) {
+                return false;
+            }
+        }
+    }
+
+    for (int i = 0; i < PLANOS_BITS_MAX; i++) {
+        ciclos[i] = 0xffff;
+    }
+    if (!comparar(ciclos)) {
+        return false;
+    }
+
+    srand(1);
+    for (int n = 0; n < 100000; n++) {
+        for (int i = 0; i < PLANOS_BITS_MAX; i++) {
+            ciclos[i] = (uint16_t) rand();
+        }
+        if (!comparar(ciclos)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static double medir(funcao_transpor_t funcao, long quadros) {
+    uint16_t ciclos[PLANOS_BITS_MAX];
+    uint16_t planos[PLANOS_BITS_MAX];
+    volatile uint16_t soma = 0;
+
+    for (int i = 0; i < PLANOS_BITS_MAX; i++) {
+        ciclos[i] = (uint16_t) (i * 4099u);
+    }
+
+    struct timespec inicio;
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    for (long n = 0; n < quadros; n++) {
+        ciclos[n & (PLANOS_BITS_MAX - 1)]++;
+        funcao(ciclos, planos);
+        soma += planos[n & (PLANOS_BITS_MAX - 1)];
+    }
+    return segundos_desde(&inicio) * 1e9 / (double) quadros;
+}
+
+int main(int argc, char **argv) {
+    long quadros = (argc > 1 ? atol(argv[1]) : 2) * 1000000L;
+
+    if (!conferir()) {
+        return 1;
+    }
+    printf("transposicao confere com o modelo de referencia\n");
+
+    printf("%-12s %10s\n", "variante", "ns/quadro");
+    printf("%-12s %10.1f\n", "referencia", medir(planos_bits_transpor_referencia, quadros));
+    printf("%-12s %10.1f\n", "rapida", medir(planos_bits_transpor, quadros));
+    return 0;
+}
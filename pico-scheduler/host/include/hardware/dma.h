@@ -0,0 +1,17 @@
+#ifndef HOST_HARDWARE_DMA_H
+#define HOST_HARDWARE_DMA_H
+
+#include "pico.h"
+
+/**
+ * Canais de DMA simulados: nunca ocupados, sem IRQs
+ */
+
+#define NUM_DMA_CHANNELS 12
+
+bool dma_channel_is_busy(uint canal);
+bool dma_channel_get_irq1_status(uint canal);
+void dma_channel_acknowledge_irq1(uint canal);
+void dma_channel_set_irq1_enabled(uint canal, bool habilitada);
+
+#endif
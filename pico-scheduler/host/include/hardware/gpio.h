@@ -0,0 +1,35 @@
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "pico.h"
+
+/**
+ * Registradores de IRQ do banco 0 simulados; nenhuma borda acontece no host
+ */
+
+#define NUM_BANK0_GPIOS 30
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+typedef struct {
+    io_rw_32 inte[4];
+    io_rw_32 intf[4];
+    io_rw_32 ints[4];
+} io_irq_ctrl_hw_t;
+
+typedef struct {
+    io_irq_ctrl_hw_t proc0_irq_ctrl;
+    io_irq_ctrl_hw_t proc1_irq_ctrl;
+} io_bank0_hw_t;
+
+extern io_bank0_hw_t *io_bank0_hw;
+
+void gpio_acknowledge_irq(uint gpio, uint32_t eventos);
+uint32_t gpio_get_irq_event_mask(uint gpio);
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico.h"
+
+/**
+ * IRQs simuladas: irq_set_pending executa o handler na hora (se estiver
+ * habilitado e nao houver outro handler em execucao)
+ */
+
+typedef void (*irq_handler_t)(void);
+
+#define IO_IRQ_BANK0 13
+#define DMA_IRQ_0 11
+#define DMA_IRQ_1 12
+#define FIRST_USER_IRQ 26
+#define NUM_USER_IRQS 6
+#define NUM_IRQS 32
+
+#define PICO_LOWEST_IRQ_PRIORITY 0xff
+#define PICO_SHARED_IRQ_HANDLER_HIGHEST_ORDER_PRIORITY 0xff
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+int user_irq_claim_unused(bool required);
+void irq_set_exclusive_handler(uint numero, irq_handler_t handler);
+void irq_add_shared_handler(uint numero, irq_handler_t handler, uint8_t prioridade_ordem);
+void irq_set_priority(uint numero, uint8_t prioridade);
+void irq_set_enabled(uint numero, bool habilitada);
+void irq_set_pending(uint numero);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico.h"
+
+/**
+ * Com um unico core simulado e IRQs sincronas, os spinlocks nao precisam
+ * travar nada; __wfe() e onde o relogio virtual avanca ate o proximo alarme
+ */
+
+typedef volatile uint32_t spin_lock_t;
+
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint numero);
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *trava) {
+    (void) trava;
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t *trava, uint32_t salvo) {
+    (void) trava;
+    (void) salvo;
+}
+
+void __wfe(void);
+void __sev(void);
+
+#endif
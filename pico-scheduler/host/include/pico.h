@@ -0,0 +1,41 @@
+#ifndef HOST_PICO_H
+#define HOST_PICO_H
+
+/**
+ * Substitutos do Pico SDK para compilar o escalonador no host (Linux).
+ * Apenas o que o escalonador usa; o comportamento vem de sim/simulador.c.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef volatile uint32_t io_rw_32;
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#ifndef MIN
+#define MIN(a, b) ((b) < (a) ? (b) : (a))
+#endif
+
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define __unused __attribute__((unused))
+
+#define hard_assert(x) ((void) (x))
+
+static inline void tight_loop_contents(void) {
+}
+
+static inline void hw_set_bits(io_rw_32 *registrador, uint32_t mascara) {
+    *registrador |= mascara;
+}
+
+static inline void hw_clear_bits(io_rw_32 *registrador, uint32_t mascara) {
+    *registrador &= ~mascara;
+}
+
+#endif
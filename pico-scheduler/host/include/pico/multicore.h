@@ -0,0 +1,11 @@
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+#include "pico.h"
+
+/**
+ * O simulador executa um unico core (SCHEDULER_NUM_CORES=1)
+ */
+void multicore_launch_core1(void (*entrada)(void));
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include "pico.h"
+#include "pico/time.h"
+
+bool stdio_init_all(void);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include "pico.h"
+
+/**
+ * Relogio e alarmes do SDK sobre o relogio virtual do simulador: o tempo
+ * so avanca em sim_avancar_us() e quando o despachante dorme em __wfe()
+ */
+
+typedef uint64_t absolute_time_t;
+typedef int32_t alarm_id_t;
+
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *temporizador);
+
+struct repeating_timer {
+    int64_t delay_us;
+    alarm_id_t alarm_id;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+
+uint64_t time_us_64(void);
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t) time_us_64();
+}
+
+static inline absolute_time_t from_us_since_boot(uint64_t us) {
+    return us;
+}
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+alarm_id_t add_alarm_at(absolute_time_t quando, alarm_callback_t callback, void *user_data,
+                        bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void *user_data, repeating_timer_t *temporizador);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, repeating_timer_t *temporizador);
+bool cancel_repeating_timer(repeating_timer_t *temporizador);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+
+#endif
@@ -0,0 +1,372 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "simulador.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+#include "hardware/dma.h"
+
+#define MAX_ALARMES 64
+
+/**
+ * Alarme pendente; `temporizador` e nao nulo para os repetitivos
+ */
+typedef struct {
+    bool usado;
+    alarm_id_t id;
+    uint64_t quando_us;
+    alarm_callback_t callback;
+    void *user_data;
+    repeating_timer_t *temporizador;
+} alarme_sim_t;
+
+/**
+ * Instante inicial do relogio virtual. Como no hardware, o relogio ja
+ * andou um pouco quando o programa comeca (o escalonador usa 0 como
+ * "medicao ainda nao iniciada").
+ */
+#define INICIO_US 1000u
+
+static uint64_t agora_us = INICIO_US;
+static alarme_sim_t alarmes[MAX_ALARMES];
+static alarm_id_t proximo_id = 1;
+static uint64_t disparados = 0;
+
+static uint64_t fim_us = UINT64_MAX;
+static void (*ao_terminar)(void) = NULL;
+
+static bool evento = false;
+
+static irq_handler_t handlers[NUM_IRQS];
+static bool habilitadas[NUM_IRQS];
+static uint32_t irqs_pendentes = 0;
+static bool em_irq = false;
+static uint proxima_user_irq = 0;
+static uint proximo_spinlock = 0;
+static spin_lock_t spinlocks[32];
+
+static io_bank0_hw_t banco0;
+io_bank0_hw_t *io_bank0_hw = &banco0;
+
+void sim_reiniciar(void) {
+    agora_us = INICIO_US;
+    for (uint i = 0; i < MAX_ALARMES; i++) {
+        alarmes[i].usado = false;
+    }
+    proximo_id = 1;
+    disparados = 0;
+    fim_us = UINT64_MAX;
+    ao_terminar = NULL;
+    evento = false;
+    for (uint i = 0; i < NUM_IRQS; i++) {
+        handlers[i] = NULL;
+        habilitadas[i] = false;
+    }
+    irqs_pendentes = 0;
+    em_irq = false;
+    proxima_user_irq = 0;
+    proximo_spinlock = 0;
+}
+
+void sim_definir_fim(uint64_t fim, void (*terminar)(void)) {
+    fim_us = fim;
+    ao_terminar = terminar;
+}
+
+uint64_t sim_alarmes_disparados(void) {
+    return disparados;
+}
+
+/**
+ * Fim do tempo simulado
+ */
+static void terminar(void) {
+    if (ao_terminar) {
+        ao_terminar();
+    }
+    exit(0);
+}
+
+/**
+ * Executa os handlers das IRQs pendentes, uma de cada vez
+ */
+static void executar_irqs(void) {
+    if (em_irq) {
+        return;
+    }
+
+    while (irqs_pendentes) {
+        uint numero = (uint) __builtin_ctz(irqs_pendentes);
+        irqs_pendentes &= ~(1u << numero);
+
+        if (habilitadas[numero] && handlers[numero]) {
+            em_irq = true;
+            handlers[numero]();
+            em_irq = false;
+        }
+    }
+}
+
+/**
+ * Alarme pendente mais proximo
+ * @return NULL se nao houver alarmes
+ */
+static alarme_sim_t *proximo_alarme(void) {
+    alarme_sim_t *proximo = NULL;
+
+    for (uint i = 0; i < MAX_ALARMES; i++) {
+        if (alarmes[i].usado && (!proximo || alarmes[i].quando_us < proximo->quando_us)) {
+            proximo = &alarmes[i];
+        }
+    }
+    return proximo;
+}
+
+/**
+ * Dispara um alarme no instante dele, como a IRQ do timer faria
+ */
+static void disparar(alarme_sim_t *alarme) {
+    alarme_sim_t copia = *alarme;
+    int64_t reagendar_us = 0;
+
+    alarme->usado = false;
+    if (copia.quando_us > agora_us) {
+        agora_us = copia.quando_us;
+    }
+    disparados++;
+
+    bool estava_em_irq = em_irq;
+    em_irq = true;
+    if (copia.temporizador) {
+        // Como no SDK, o temporizador devolve o proprio delay_us
+        if (copia.temporizador->callback(copia.temporizador)) {
+            reagendar_us = copia.temporizador->delay_us;
+        }
+    } else {
+        reagendar_us = copia.callback(copia.id, copia.user_data);
+    }
+    em_irq = estava_em_irq;
+
+    // Mesma convencao do SDK: < 0 a partir do prazo anterior, > 0 a partir do
+    // retorno do callback (agora)
+    if (reagendar_us != 0) {
+        for (uint i = 0; i < MAX_ALARMES; i++) {
+            if (!alarmes[i].usado) {
+                alarmes[i] = copia;
+                alarmes[i].usado = true;
+                alarmes[i].quando_us = reagendar_us < 0 ? copia.quando_us + (uint64_t) -reagendar_us
+                                                        : agora_us + (uint64_t) reagendar_us;
+                break;
+            }
+        }
+    }
+
+    executar_irqs();
+}
+
+void sim_avancar_us(uint64_t us) {
+    uint64_t alvo_us = agora_us + us;
+    alarme_sim_t *alarme;
+
+    while ((alarme = proximo_alarme()) && alarme->quando_us <= alvo_us) {
+        // O tempo gasto nas IRQs (tarefas preemptivas) atrasa este trabalho
+        uint64_t antes_us = MAX(agora_us, alarme->quando_us);
+        disparar(alarme);
+        alvo_us += agora_us - antes_us;
+    }
+
+    agora_us = alvo_us;
+
+    // Com o core sempre ocupado o despachante nunca chega ao __wfe()
+    if (agora_us >= fim_us) {
+        terminar();
+    }
+}
+
+uint64_t time_us_64(void) {
+    return agora_us;
+}
+
+static alarm_id_t inserir_alarme(uint64_t quando_us, alarm_callback_t callback, void *user_data,
+                                 repeating_timer_t *temporizador) {
+    for (uint i = 0; i < MAX_ALARMES; i++) {
+        if (!alarmes[i].usado) {
+            alarmes[i] = (alarme_sim_t) {
+                .usado = true,
+                .id = proximo_id++,
+                .quando_us = quando_us,
+                .callback = callback,
+                .user_data = user_data,
+                .temporizador = temporizador,
+            };
+            return alarmes[i].id;
+        }
+    }
+
+    fprintf(stderr, "simulador: limite de %d alarmes atingido\n", MAX_ALARMES);
+    abort();
+}
+
+alarm_id_t add_alarm_at(absolute_time_t quando, alarm_callback_t callback, void *user_data,
+                        bool fire_if_past) {
+    if (quando <= agora_us) {
+        if (!fire_if_past) {
+            return 0;
+        }
+        quando = agora_us;
+    }
+    return inserir_alarme(quando, callback, user_data, NULL);
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data,
+                           bool fire_if_past) {
+    return add_alarm_at(agora_us + us, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t id) {
+    for (uint i = 0; i < MAX_ALARMES; i++) {
+        if (alarmes[i].usado && alarmes[i].id == id) {
+            alarmes[i].usado = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback,
+                            void *user_data, repeating_timer_t *temporizador) {
+    uint64_t periodo_us = (uint64_t) (delay_us < 0 ? -delay_us : delay_us);
+
+    temporizador->delay_us = delay_us;
+    temporizador->callback = callback;
+    temporizador->user_data = user_data;
+    temporizador->alarm_id = inserir_alarme(agora_us + periodo_us, NULL, NULL, temporizador);
+    return true;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback,
+                            void *user_data, repeating_timer_t *temporizador) {
+    return add_repeating_timer_us((int64_t) delay_ms * 1000, callback, user_data, temporizador);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *temporizador) {
+    for (uint i = 0; i < MAX_ALARMES; i++) {
+        if (alarmes[i].usado && alarmes[i].temporizador == temporizador) {
+            alarmes[i].usado = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+void sleep_us(uint64_t us) {
+    sim_avancar_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    sim_avancar_us((uint64_t) ms * 1000u);
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+void __sev(void) {
+    evento = true;
+}
+
+void __wfe(void) {
+    if (!evento) {
+        // Dorme ate o proximo alarme, ou termina se ele passar do fim
+        alarme_sim_t *alarme = proximo_alarme();
+
+        if (!alarme || alarme->quando_us > fim_us) {
+            if (fim_us != UINT64_MAX && agora_us < fim_us) {
+                agora_us = fim_us;
+            }
+            terminar();
+        }
+
+        disparar(alarme);
+    }
+    evento = false;
+}
+
+int spin_lock_claim_unused(bool required) {
+    (void) required;
+    return (int) (proximo_spinlock++ % count_of(spinlocks));
+}
+
+spin_lock_t *spin_lock_instance(uint numero) {
+    return &spinlocks[numero % count_of(spinlocks)];
+}
+
+int user_irq_claim_unused(bool required) {
+    if (proxima_user_irq >= NUM_USER_IRQS) {
+        if (required) {
+            abort();
+        }
+        return -1;
+    }
+    return (int) (FIRST_USER_IRQ + proxima_user_irq++);
+}
+
+void irq_set_exclusive_handler(uint numero, irq_handler_t handler) {
+    handlers[numero] = handler;
+}
+
+void irq_add_shared_handler(uint numero, irq_handler_t handler, uint8_t prioridade_ordem) {
+    (void) prioridade_ordem;
+    handlers[numero] = handler;
+}
+
+void irq_set_priority(uint numero, uint8_t prioridade) {
+    (void) numero;
+    (void) prioridade;
+}
+
+void irq_set_enabled(uint numero, bool habilitada) {
+    habilitadas[numero] = habilitada;
+}
+
+void irq_set_pending(uint numero) {
+    irqs_pendentes |= 1u << numero;
+    executar_irqs();
+}
+
+void multicore_launch_core1(void (*entrada)(void)) {
+    (void) entrada;
+    fprintf(stderr, "simulador: apenas um core (compile com SCHEDULER_NUM_CORES=1)\n");
+    abort();
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t eventos) {
+    (void) gpio;
+    (void) eventos;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+    (void) gpio;
+    return 0;
+}
+
+bool dma_channel_is_busy(uint canal) {
+    (void) canal;
+    return false;
+}
+
+bool dma_channel_get_irq1_status(uint canal) {
+    (void) canal;
+    return false;
+}
+
+void dma_channel_acknowledge_irq1(uint canal) {
+    (void) canal;
+}
+
+void dma_channel_set_irq1_enabled(uint canal, bool habilitada) {
+    (void) canal;
+    (void) habilitada;
+}
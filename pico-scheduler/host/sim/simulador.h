@@ -0,0 +1,40 @@
+#ifndef SIMULADOR_H
+#define SIMULADOR_H
+
+#include <stdint.h>
+
+/**
+ * Simulador do RP2040 para rodar o escalonador no host.
+ *
+ * O tempo e um relogio virtual em microssegundos que comeca em 1 ms: ele so
+ * avanca quando uma tarefa "trabalha" (sim_avancar_us) ou quando o
+ * despachante dorme em __wfe(), que salta direto para o proximo alarme.
+ * Os alarmes disparam em ordem e as IRQs sao executadas de forma sincrona,
+ * entao cada execucao e deterministica e reproduzivel.
+ */
+
+/**
+ * Volta o relogio ao inicio e descarta alarmes, IRQs e o fim da simulacao
+ */
+void sim_reiniciar(void);
+
+/**
+ * Simula `us` microssegundos de processamento, disparando no caminho os
+ * alarmes vencidos (e o tempo gasto nas IRQs atrasa o fim do trabalho)
+ */
+void sim_avancar_us(uint64_t us);
+
+/**
+ * Encerra a simulacao quando o relogio alcancar `fim_us` (ou quando nao
+ * houver mais alarmes): `ao_terminar` e chamada de dentro do __wfe() do
+ * despachante ou do trabalho de uma tarefa e pode escrever o relatorio;
+ * em seguida o processo termina com exit(0)
+ */
+void sim_definir_fim(uint64_t fim_us, void (*ao_terminar)(void));
+
+/**
+ * Quantos alarmes ja dispararam desde sim_reiniciar
+ */
+uint64_t sim_alarmes_disparados(void);
+
+#endif
@@ -0,0 +1,155 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "pico.h"
+#include "pico/time.h"
+#include "scheduler.h"
+#include "console.h"
+#include "fila_prazos.h"
+#include "simulador.h"
+
+/**
+ * Teste do custo de despacho do escalonador no host.
+ *
+ * Para N = 4 .. 256 tarefas, simula alguns segundos de relogio virtual e
+ * conta as comparacoes de prazo feitas pelas filas (fila_prazos compilada
+ * com FILA_PRAZOS_CONTAR) por execucao de tarefa. Com o heap, o custo deve
+ * crescer com log2(N): o teste falha se as comparacoes por despacho
+ * passarem de COMPARACOES_POR_NIVEL * log2(N) ou se, de 4 para 256 tarefas,
+ * crescerem mais que o dobro da razao entre os logaritmos (uma varredura
+ * linear cresceria 64 vezes).
+ *
+ * Uso: teste_despacho (codigo de saida 0 = passou)
+ */
+
+#define SEGUNDOS_SIMULADOS 2
+
+/**
+ * Comparacoes por nivel do heap admitidas em um despacho. Retirar o topo
+ * custa duas por nivel ao descer e reinserir quase nada (prazos crescem);
+ * o dobro disso e folga para as filas de prontas
+ */
+#define COMPARACOES_POR_NIVEL 4.0
+
+static const uint32_t periodos_ms[] = { 10, 20, 50, 100 };
+
+/**
+ * Trabalho curto: com o core folgado toda liberacao vira um despacho
+ */
+static void tarefa_curta(void) {
+    sim_avancar_us(1);
+}
+
+static tarefa_handle_t handles[SCHEDULER_MAX_TASKS];
+static uint32_t num_tarefas = 0;
+static int saida = -1;
+
+/**
+ * Chamada pelo simulador no fim do tempo virtual: envia as comparacoes por
+ * despacho ao processo pai
+ */
+static void relatorio(void) {
+    uint64_t execucoes = 0;
+
+    for (uint32_t i = 0; i < num_tarefas; i++) {
+        tarefa_stats_t stats;
+        if (scheduler_get_stats(handles[i], &stats)) {
+            execucoes += stats.execucoes;
+        }
+    }
+
+    double por_despacho = execucoes ? (double) fila_prazos_comparacoes / (double) execucoes : 0.0;
+    if (write(saida, &por_despacho, sizeof(por_despacho)) != sizeof(por_despacho)) {
+        exit(1);
+    }
+}
+
+/**
+ * Executa uma simulacao (no processo filho; scheduler_start nao retorna)
+ */
+static void simular(uint32_t n) {
+    sim_reiniciar();
+    console_init();
+    scheduler_init();
+
+    num_tarefas = n;
+    for (uint32_t i = 0; i < n; i++) {
+        handles[i] = scheduler_add_task(tarefa_curta, periodos_ms[i % count_of(periodos_ms)]);
+    }
+
+    // So conta o regime: as insercoes iniciais ficam de fora
+    fila_prazos_comparacoes = 0;
+    sim_definir_fim(time_us_64() + SEGUNDOS_SIMULADOS * 1000000u, relatorio);
+    scheduler_start();
+}
+
+/**
+ * Comparacoes por despacho com n tarefas
+ * @return valor negativo se a simulacao falhar
+ */
+static double medir(uint32_t n) {
+    int canal[2];
+    double por_despacho = -1.0;
+
+    fflush(stdout);
+    if (pipe(canal) < 0) {
+        return -1.0;
+    }
+
+    pid_t filho = fork();
+    if (filho == 0) {
+        close(canal[0]);
+        saida = canal[1];
+        simular(n);
+    }
+    close(canal[1]);
+
+    int estado;
+    if (filho < 0 || read(canal[0], &por_despacho, sizeof(por_despacho)) != sizeof(por_despacho) ||
+        waitpid(filho, &estado, 0) < 0 || !WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+        por_despacho = -1.0;
+    }
+    close(canal[0]);
+    return por_despacho;
+}
+
+int main(void) {
+    static const uint32_t tamanhos[] = { 4, 8, 16, 32, 64, 128, 256 };
+    double medidas[count_of(tamanhos)];
+    bool passou = true;
+
+    printf("%8s %14s %10s\n", "tarefas", "comparacoes", "limite");
+
+    for (uint32_t i = 0; i < count_of(tamanhos); i++) {
+        uint32_t n = tamanhos[i];
+        double limite = COMPARACOES_POR_NIVEL * log2((double) n);
+
+        medidas[i] = medir(n);
+        if (medidas[i] < 0) {
+            fprintf(stderr, "simulacao com %lu tarefas falhou\n", (unsigned long) n);
+            return 1;
+        }
+
+        printf("%8lu %14.2f %10.2f\n", (unsigned long) n, medidas[i], limite);
+        if (medidas[i] > limite) {
+            fprintf(stderr, "%lu tarefas: %.2f comparacoes por despacho, limite %.2f\n",
+                    (unsigned long) n, medidas[i], limite);
+            passou = false;
+        }
+    }
+
+    // Crescimento de ponta a ponta contra a razao dos logaritmos (4x)
+    uint32_t ultimo = count_of(tamanhos) - 1;
+    double crescimento = medidas[ultimo] / medidas[0];
+    double razao_log = log2((double) tamanhos[ultimo]) / log2((double) tamanhos[0]);
+    printf("crescimento %lu -> %lu tarefas: %.2fx (log: %.2fx)\n", (unsigned long) tamanhos[0],
+           (unsigned long) tamanhos[ultimo], crescimento, razao_log);
+    if (crescimento > 2.0 * razao_log) {
+        fprintf(stderr, "custo de despacho cresce mais que logaritmicamente\n");
+        passou = false;
+    }
+
+    return passou ? 0 : 1;
+}